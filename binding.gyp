@@ -39,6 +39,16 @@
           'cflags_cc': ['-std=c++11']
         }]
       ]
+    },
+    {
+      'target_name': 'fake_debugger',
+      'type': 'executable',
+      'sources': ['test/fake_debugger.cpp'],
+      'conditions': [
+        ["OS=='linux'", {
+          'cflags_cc': ['-std=c++11']
+        }]
+      ]
     }
   ]
 }
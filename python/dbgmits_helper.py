@@ -0,0 +1,176 @@
+# Copyright (c) 2016 Vadim Macagon
+# MIT License, see LICENSE file for full terms.
+
+"""GDB extension loaded by DebugSession.loadPythonHelper().
+
+Adds MI commands that gather, in a single round trip, data that would otherwise require dozens
+of MI commands to retrieve. The results are returned as compact JSON strings.
+
+MI commands can only be implemented in Python in GDB 14 and later, earlier versions will load
+this file without error but won't gain any new commands.
+"""
+
+import json
+
+import gdb
+
+# must match the VariableDetailLevel enum in src/types.ts
+DETAIL_NONE = 0
+DETAIL_ALL = 1
+DETAIL_SIMPLE = 2
+
+_AGGREGATE_TYPE_CODES = (gdb.TYPE_CODE_STRUCT, gdb.TYPE_CODE_UNION, gdb.TYPE_CODE_ARRAY)
+
+
+def _describe_variable(frame, symbol, detail):
+    info = {'name': symbol.print_name}
+    if detail == DETAIL_NONE:
+        return info
+    try:
+        value = symbol.value(frame)
+        if detail == DETAIL_SIMPLE:
+            info['type'] = str(symbol.type)
+            if value.type.strip_typedefs().code in _AGGREGATE_TYPE_CODES:
+                return info
+        info['value'] = str(value)
+    except (gdb.error, RuntimeError) as err:
+        info['value'] = '<error: %s>' % err
+    return info
+
+
+def _frame_variables(frame, detail, include_locals):
+    """Returns the arguments and locals of a frame, innermost block first."""
+    args = []
+    local_vars = []
+    try:
+        block = frame.block()
+    except RuntimeError:
+        # no debug info for this frame
+        return args, local_vars
+    names = set()
+    while block is not None:
+        for symbol in block:
+            if symbol.is_argument:
+                variables = args
+            elif symbol.is_variable and include_locals:
+                variables = local_vars
+            else:
+                continue
+            # variables in inner blocks shadow those in outer blocks
+            if symbol.print_name in names:
+                continue
+            names.add(symbol.print_name)
+            variables.append(_describe_variable(frame, symbol, detail))
+        if block.function is not None:
+            break
+        block = block.superblock
+    return args, local_vars
+
+
+def _describe_frame(frame, level, address_format):
+    pc = frame.pc()
+    info = {'level': level, 'address': address_format % pc}
+    name = frame.name()
+    if name:
+        info['func'] = name
+    sal = frame.find_sal()
+    if sal.symtab is not None:
+        info['filename'] = sal.symtab.filename
+        info['fullname'] = sal.symtab.fullname()
+        info['line'] = sal.line
+    else:
+        library = gdb.solib_name(pc)
+        if library:
+            info['from'] = library
+    return info
+
+
+def _read_registers(frame):
+    """Returns the hex formatted register values of a frame keyed by name."""
+    values = {}
+    for register in frame.architecture().registers():
+        try:
+            values[register.name] = frame.read_register(register).format_string(format='x')
+        except (gdb.error, RuntimeError):
+            pass
+    return values
+
+
+def _thread_id(thread):
+    """Returns the id MI uses for a thread, which is unique across all the inferiors."""
+    # InferiorThread.global_num is only available in GDB 7.11 and later, older versions don't
+    # support multiple inferiors with separate thread numbering
+    return getattr(thread, 'global_num', thread.num)
+
+
+def _capture_thread(thread, max_frames, detail, include_locals, include_registers,
+                    address_format):
+    result = {'id': _thread_id(thread), 'frames': []}
+    if thread.is_running():
+        result['errors'] = ['Thread is running.']
+        return result
+    try:
+        thread.switch()
+        frame = gdb.newest_frame()
+        level = 0
+        while (frame is not None) and ((max_frames <= 0) or (level < max_frames)):
+            info = _describe_frame(frame, level, address_format)
+            args, local_vars = _frame_variables(frame, detail, include_locals)
+            info['args'] = args
+            if include_locals:
+                info['locals'] = local_vars
+            result['frames'].append(info)
+            frame = frame.older()
+            level += 1
+        if include_registers:
+            result['registers'] = _read_registers(gdb.newest_frame())
+    except gdb.error as err:
+        result['errors'] = [str(err)]
+    return result
+
+
+if hasattr(gdb, 'MICommand'):
+    class SnapshotCommand(gdb.MICommand):
+        """-dbgmits-snapshot MAX-FRAMES DETAIL INCLUDE-LOCALS INCLUDE-REGISTERS
+
+        Captures the frames (along with their arguments and locals) of all the threads, and
+        optionally the registers of the innermost frame of each thread. MAX-FRAMES is the maximum
+        number of frames to capture per thread (zero for all), DETAIL is a VariableDetailLevel,
+        INCLUDE-LOCALS and INCLUDE-REGISTERS are either 0 or 1.
+        """
+
+        def __init__(self):
+            super(SnapshotCommand, self).__init__('-dbgmits-snapshot')
+
+        def invoke(self, argv):
+            if len(argv) != 4:
+                raise gdb.GdbError('-dbgmits-snapshot: Expected 4 arguments.')
+            max_frames = int(argv[0])
+            detail = int(argv[1])
+            include_locals = argv[2] == '1'
+            include_registers = argv[3] == '1'
+            pointer_size = gdb.lookup_type('void').pointer().sizeof
+            address_format = '0x%%0%dx' % (pointer_size * 2)
+
+            selected_thread = gdb.selected_thread()
+            try:
+                selected_frame = gdb.selected_frame()
+            except gdb.error:
+                selected_frame = None
+            threads = []
+            try:
+                for inferior in gdb.inferiors():
+                    for thread in sorted(inferior.threads(), key=_thread_id):
+                        threads.append(_capture_thread(
+                            thread, max_frames, detail, include_locals, include_registers,
+                            address_format
+                        ))
+            finally:
+                # leave the debugger the way it was found
+                if (selected_thread is not None) and selected_thread.is_valid():
+                    selected_thread.switch()
+                    if (selected_frame is not None) and selected_frame.is_valid():
+                        selected_frame.select()
+            return {'snapshot': json.dumps({'threads': threads}, separators=(',', ':'))}
+
+    SnapshotCommand()
@@ -0,0 +1,177 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+const twoPow32 = 0x100000000;
+
+/**
+ * An unsigned 64-bit address.
+ *
+ * The debugger outputs addresses as hex literals, which have to be parsed before they can be
+ * sorted, compared, or used in range arithmetic. A JavaScript number can't hold every 64-bit
+ * address exactly, so the address is stored as two 32-bit halves instead.
+ *
+ * Instances are immutable.
+ */
+export class Address {
+  /** The most significant 32 bits of the address. */
+  readonly high: number;
+  /** The least significant 32 bits of the address. */
+  readonly low: number;
+
+  constructor(high: number, low: number) {
+    this.high = high;
+    this.low = low;
+  }
+
+  /**
+   * Parses an address output by the debugger.
+   *
+   * @param value A hex literal (e.g. `0x00000000004005d4`), or a decimal integer.
+   * @returns The parsed address, or `undefined` if `value` isn't a valid 64-bit address.
+   */
+  static parse(value: string): Address {
+    const match = /^(?:0x([0-9a-f]{1,16})|([0-9]{1,20}))$/i.exec(value);
+    if (!match) {
+      return undefined;
+    }
+    if (match[1] !== undefined) {
+      const split = Math.max(match[1].length - 8, 0);
+      return new Address(
+        (split > 0) ? parseInt(match[1].substr(0, split), 16) : 0,
+        parseInt(match[1].substr(split), 16)
+      );
+    }
+    // decimal, accumulate in 16-bit limbs to avoid losing precision
+    const limbs = [0, 0, 0, 0, 0];
+    for (let i = 0; i < match[2].length; ++i) {
+      let carry = match[2].charCodeAt(i) - 48;
+      for (let j = 0; j < limbs.length; ++j) {
+        const n = (limbs[j] * 10) + carry;
+        limbs[j] = n % 0x10000;
+        carry = Math.floor(n / 0x10000);
+      }
+    }
+    if (limbs[4] > 0) {
+      return undefined;
+    }
+    return new Address((limbs[3] * 0x10000) + limbs[2], (limbs[1] * 0x10000) + limbs[0]);
+  }
+
+  /**
+   * Creates an address from a number.
+   *
+   * @param value A non-negative integer, which must not exceed `Number.MAX_SAFE_INTEGER`.
+   */
+  static fromNumber(value: number): Address {
+    return new Address(Math.floor(value / twoPow32), value % twoPow32);
+  }
+
+  /** Comparison function for sorting addresses in ascending order with `Array.sort()`. */
+  static compare(a: Address, b: Address): number {
+    return (a.high !== b.high) ? (a.high - b.high) : (a.low - b.low);
+  }
+
+  /** Checks if this address is the same as another one. */
+  equals(other: Address): boolean {
+    return (this.high === other.high) && (this.low === other.low);
+  }
+
+  /**
+   * Computes the address that's a number of bytes away from this one, wrapping around at the
+   * ends of the address space.
+   *
+   * @param offset Number of bytes to add, may be negative.
+   */
+  add(offset: number): Address {
+    const low = this.low + offset;
+    const carry = Math.floor(low / twoPow32);
+    const high = (this.high + carry) % twoPow32;
+    return new Address((high < 0) ? high + twoPow32 : high, low - (carry * twoPow32));
+  }
+
+  /**
+   * Computes the number of bytes from another address to this one.
+   *
+   * @returns A number that's negative if `other` is above this address, the result is only exact
+   *          if its magnitude doesn't exceed `Number.MAX_SAFE_INTEGER`.
+   */
+  subtract(other: Address): number {
+    return ((this.high - other.high) * twoPow32) + (this.low - other.low);
+  }
+
+  /**
+   * Converts the address to a number, the result is only exact if the address doesn't exceed
+   * `Number.MAX_SAFE_INTEGER` (which is always the case for user space addresses on current
+   * 64-bit platforms).
+   */
+  toNumber(): number {
+    return (this.high * twoPow32) + this.low;
+  }
+
+  /**
+   * Converts the address to a hex literal that can be passed to the debugger, the result can also
+   * be used as a key in a `Map`.
+   */
+  toString(): string {
+    if (this.high === 0) {
+      return '0x' + this.low.toString(16);
+    }
+    return '0x' + this.high.toString(16) + ('0000000' + this.low.toString(16)).slice(-8);
+  }
+
+  /** Converts the address to a hex literal, called by `JSON.stringify()`. */
+  toJSON(): string {
+    return this.toString();
+  }
+}
+
+/** A contiguous range of addresses. */
+export interface IAddressRange {
+  /** The first address in the range. */
+  begin: Address;
+  /** The address just past the end of the range. */
+  end: Address;
+}
+
+/** Computes the number of bytes in an address range. */
+export function getRangeLength(range: IAddressRange): number {
+  return range.end.subtract(range.begin);
+}
+
+/** Checks if an address is within an address range. */
+export function isAddressInRange(address: Address, range: IAddressRange): boolean {
+  return (Address.compare(address, range.begin) >= 0) && (Address.compare(address, range.end) < 0);
+}
+
+/**
+ * Computes the overlap between two address ranges.
+ *
+ * @returns The addresses that are in both ranges, or `undefined` if the ranges don't overlap.
+ */
+export function intersectRanges(a: IAddressRange, b: IAddressRange): IAddressRange {
+  const begin = (Address.compare(a.begin, b.begin) >= 0) ? a.begin : b.begin;
+  const end = (Address.compare(a.end, b.end) <= 0) ? a.end : b.end;
+  return (Address.compare(begin, end) < 0) ? { begin, end } : undefined;
+}
+
+/**
+ * Finds the range that contains an address.
+ *
+ * @param ranges Non-overlapping ranges sorted by their start addresses.
+ * @returns The index of the range that contains the address, or `-1` if there isn't one.
+ */
+export function findRange(ranges: IAddressRange[], address: Address): number {
+  let low = 0;
+  let high = ranges.length - 1;
+  while (low <= high) {
+    const mid = Math.floor((low + high) / 2);
+    if (Address.compare(address, ranges[mid].begin) < 0) {
+      high = mid - 1;
+    } else if (Address.compare(address, ranges[mid].end) >= 0) {
+      low = mid + 1;
+    } else {
+      return mid;
+    }
+  }
+  return -1;
+}
@@ -0,0 +1,213 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+import DebugSession from './debug_session';
+import { IStackFrameInfo, TargetStopReason } from './types';
+
+/** Statistics collected by [[BacktraceCache]]. */
+export interface IBacktraceCacheStats {
+  /** Number of backtraces that were served without sending any commands to the debugger. */
+  hits: number;
+  /** Number of backtraces that had to be (at least partially) retrieved from the debugger. */
+  misses: number;
+  /** Number of frames retrieved from the debugger. */
+  framesRetrieved: number;
+  /** Number of frames that were reused from a previously retrieved backtrace. */
+  framesReused: number;
+}
+
+// once this many of the innermost frames have been retrieved without finding a match the rest of
+// the frames are retrieved in one go
+const maxWindowSize = 8;
+
+interface IBacktraceEntry {
+  frames: IStackFrameInfo[];
+  // set once the frames have been checked against the stack of the stopped target, and cleared
+  // when the target resumes execution
+  isValid: boolean;
+  // set when the frames are retrieved, and cleared if the target stops for any reason other than
+  // the thread finishing a step, see BacktraceCache for details
+  canReuseFrames: boolean;
+  // the backtrace that's currently being retrieved (if any)
+  framesRetrieved: Promise<IStackFrameInfo[]>;
+}
+
+/**
+ * Caches the backtrace of each thread between stops, see [[DebugSession.getCachedStackFrames]].
+ *
+ * Stepping through the code typically only changes the innermost frame or two, the rest of the
+ * stack remains the same, so after a stop only as many of the innermost frames are retrieved as
+ * necessary to find a frame that matches a cached one. Stacks are matched from the outermost
+ * frame, so a frame at level `n` in the new backtrace can only match the frame at level
+ * `n + (oldDepth - newDepth)` in the old one, and is considered to match if it has the same code
+ * address (which for an outer frame is the return address of the call) and function. All the
+ * frames past the matching one are then reused.
+ *
+ * A matching frame doesn't prove that the frames past it are unchanged though, e.g. if a function
+ * is called from two different lines the frame of its caller will be different each time it hits
+ * a breakpoint, even though the frames below it may be identical. Frames are therefore only
+ * reused if every stop since they were retrieved was the thread itself finishing a step (or
+ * stepping out of a function), which can only change the frames up to the caller of the frame the
+ * step started in. After any other stop all the frames of the thread are retrieved again.
+ */
+export class BacktraceCache {
+  private entries = new Map<number, IBacktraceEntry>();
+  private _stats: IBacktraceCacheStats = {
+    hits: 0, misses: 0, framesRetrieved: 0, framesReused: 0
+  };
+
+  constructor(private debugSession: DebugSession) {
+  }
+
+  /** Statistics accumulated since the cache was created or [[resetStats]] was last called. */
+  get stats(): IBacktraceCacheStats {
+    return this._stats;
+  }
+
+  /** Resets all the statistics to zero. */
+  resetStats(): void {
+    this._stats = { hits: 0, misses: 0, framesRetrieved: 0, framesReused: 0 };
+  }
+
+  /** Should be called when the target resumes execution. */
+  onTargetRunning(): void {
+    this.entries.forEach((entry: IBacktraceEntry) => {
+      entry.isValid = false;
+      // frames retrieved across the resumption can't be trusted
+      entry.framesRetrieved = null;
+    });
+  }
+
+  /**
+   * Should be called when the target stops.
+   *
+   * @param reason Reason the target stopped.
+   * @param threadId Identifier of the thread that caused the target to stop.
+   */
+  onTargetStopped(reason: TargetStopReason, threadId: number): void {
+    const isStep = (reason === TargetStopReason.EndSteppingRange) ||
+      (reason === TargetStopReason.FunctionFinished);
+    this.entries.forEach((entry: IBacktraceEntry, entryThreadId: number) => {
+      // other threads may have run arbitrary code while the thread was stepping
+      if (!isStep || (entryThreadId !== threadId)) {
+        entry.canReuseFrames = false;
+      }
+    });
+  }
+
+  /** Should be called when a thread exits. */
+  onThreadExited(threadId: number): void {
+    this.entries.delete(threadId);
+  }
+
+  /** Removes all the cached backtraces. */
+  clear(): void {
+    this.entries.clear();
+  }
+
+  /** Retrieves the frames on the stack of a thread, see [[DebugSession.getCachedStackFrames]]. */
+  getStackFrames(threadId: number): Promise<IStackFrameInfo[]> {
+    let entry = this.entries.get(threadId);
+    if (entry && entry.isValid) {
+      ++this._stats.hits;
+      return entry.framesRetrieved || Promise.resolve(entry.frames.slice());
+    }
+    ++this._stats.misses;
+    if (!entry) {
+      entry = { frames: [], isValid: false, canReuseFrames: false, framesRetrieved: null };
+      this.entries.set(threadId, entry);
+    }
+    const currentEntry = entry;
+    currentEntry.isValid = true;
+    const oldFrames = currentEntry.canReuseFrames ? currentEntry.frames : [];
+    const framesRetrieved = this.retrieveFrames(threadId, oldFrames)
+    .then((frames: IStackFrameInfo[]) => {
+      // the target may have been resumed and stopped again while the frames were being retrieved
+      if (currentEntry.framesRetrieved === framesRetrieved) {
+        currentEntry.frames = frames;
+        currentEntry.canReuseFrames = true;
+        currentEntry.framesRetrieved = null;
+      }
+      return frames.slice();
+    }, (err: Error) => {
+      // the thread may be running or gone, either way the old frames are of no further use
+      if (this.entries.get(threadId) === currentEntry) {
+        this.entries.delete(threadId);
+      }
+      throw err;
+    });
+    currentEntry.framesRetrieved = framesRetrieved;
+    return framesRetrieved;
+  }
+
+  /**
+   * Retrieves the innermost frames of a thread in progressively larger windows until one of them
+   * matches a frame in the old backtrace, or all the frames have been retrieved.
+   */
+  private retrieveFrames(threadId: number, oldFrames: IStackFrameInfo[])
+    : Promise<IStackFrameInfo[]> {
+    if (oldFrames.length === 0) {
+      // nothing to match against
+      return this.debugSession.getStackFrames({ threadId })
+      .then((frames: IStackFrameInfo[]) => {
+        this._stats.framesRetrieved += frames.length;
+        return frames;
+      });
+    }
+    // most steps only change the innermost frame, so the first window only needs to include the
+    // frame that called it
+    const firstWindowSize = 2;
+    return this.debugSession.pipelineCommands(() => Promise.all([
+      this.debugSession.getStackDepth({ threadId }),
+      this.debugSession.getStackFrames({ threadId, lowFrame: 0, highFrame: firstWindowSize - 1 })
+    ]))
+    .then(([depth, frames]) => {
+      this._stats.framesRetrieved += frames.length;
+      return this.extendFrames(threadId, depth, frames, oldFrames);
+    });
+  }
+
+  private extendFrames(
+    threadId: number, depth: number, frames: IStackFrameInfo[], oldFrames: IStackFrameInfo[]
+  ): Promise<IStackFrameInfo[]> {
+    if (frames.length >= depth) {
+      return Promise.resolve(frames);
+    }
+    const lastFrame = frames[frames.length - 1];
+    const oldLevel = lastFrame.level + (oldFrames.length - depth);
+    if ((oldLevel >= 0) && (oldLevel < oldFrames.length) &&
+        isSameFrame(lastFrame, oldFrames[oldLevel])) {
+      const reusedFrames = oldFrames.slice(oldLevel + 1).map(
+        (frame: IStackFrameInfo, i: number): IStackFrameInfo => {
+          if (frame.level === lastFrame.level + 1 + i) {
+            return frame;
+          }
+          // frames aren't necessarily plain objects (see CompactStackFrame)
+          const relevelledFrame = <IStackFrameInfo> Object.assign(
+            Object.create(Object.getPrototypeOf(frame)), frame
+          );
+          relevelledFrame.level = lastFrame.level + 1 + i;
+          return relevelledFrame;
+        }
+      );
+      this._stats.framesReused += reusedFrames.length;
+      return Promise.resolve(frames.concat(reusedFrames));
+    }
+    // no match yet, so retrieve twice as many frames as before, unless it looks like the stack
+    // has changed completely, in which case just retrieve the rest of the frames
+    const highFrame = (frames.length >= maxWindowSize) ?
+      (depth - 1) : (Math.min(frames.length * 2, depth) - 1);
+    return this.debugSession.getStackFrames({ threadId, lowFrame: frames.length, highFrame })
+    .then((moreFrames: IStackFrameInfo[]) => {
+      this._stats.framesRetrieved += moreFrames.length;
+      if (moreFrames.length === 0) {
+        return Promise.resolve(frames);
+      }
+      return this.extendFrames(threadId, depth, frames.concat(moreFrames), oldFrames);
+    });
+  }
+}
+
+function isSameFrame(a: IStackFrameInfo, b: IStackFrameInfo): boolean {
+  return (a.address === b.address) && (a.func === b.func);
+}
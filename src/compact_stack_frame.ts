@@ -0,0 +1,127 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+import { IStackFrameInfo } from './types';
+import { StringPool } from './string_pool';
+import { Address } from './address';
+
+// number of bits of an address stored in CompactStackFrame.addressLow, chosen so that both halves
+// of a user space address fit in a small integer (which doesn't need to be allocated on the heap)
+const lowAddressBits = 24;
+const lowAddressDigits = lowAddressBits / 4;
+
+// fields used to store the compact representation of the frame
+const compactFields = new Set<string>([
+  'pool', 'addressHigh', 'addressLow', 'addressDigits', 'funcId', 'filenameId', 'fullnameId',
+  'fromId'
+]);
+
+/**
+ * A memory efficient [[IStackFrameInfo]].
+ *
+ * The function name and paths are stored as identifiers of strings in a [[StringPool]], and the
+ * address is stored as a pair of numbers rather than a string. The properties of the interface
+ * are implemented as getters that convert these back, so a frame should be converted to a plain
+ * object via [[toJSON]] before it's compared against another object property by property.
+ */
+export class CompactStackFrame implements IStackFrameInfo {
+  level: number;
+  line: number;
+  private addressHigh: number;
+  private addressLow: number;
+  // number of hex digits in the address, so that it's converted back to the original string
+  private addressDigits: number;
+  private funcId: number;
+  private filenameId: number;
+  private fullnameId: number;
+  private fromId: number;
+
+  constructor(private pool: StringPool, frame: IStackFrameInfo) {
+    this.level = frame.level;
+    this.line = frame.line;
+    if (frame.address && /^0x[0-9a-f]{1,16}$/.test(frame.address)) {
+      const digits = frame.address.substr(2);
+      const split = Math.max(digits.length - lowAddressDigits, 0);
+      this.addressHigh = (split > 0) ? parseInt(digits.substr(0, split), 16) : 0;
+      this.addressLow = parseInt(digits.substr(split), 16);
+      this.addressDigits = digits.length;
+    } else {
+      // not an address this class can represent exactly, so just keep the string
+      this.addressHigh = pool.getId(frame.address);
+      this.addressLow = 0;
+      this.addressDigits = 0;
+    }
+    this.funcId = pool.getId(frame.func);
+    this.filenameId = pool.getId(frame.filename);
+    this.fullnameId = pool.getId(frame.fullname);
+    this.fromId = pool.getId(frame.from);
+  }
+
+  get address(): string {
+    if (this.addressDigits === 0) {
+      return this.pool.getString(this.addressHigh);
+    }
+    let digits = this.addressLow.toString(16);
+    if (this.addressHigh > 0) {
+      digits = this.addressHigh.toString(16) + padDigits(digits, lowAddressDigits);
+    }
+    return '0x' + padDigits(digits, this.addressDigits);
+  }
+
+  /** Parsed [[address]], unlike plain frames compact frames always provide this. */
+  get numericAddress(): Address {
+    if (this.addressDigits === 0) {
+      return Address.parse(this.address);
+    }
+    const highBits = 32 - lowAddressBits;
+    const highDivisor = Math.pow(2, highBits);
+    return new Address(
+      Math.floor(this.addressHigh / highDivisor),
+      ((this.addressHigh % highDivisor) * Math.pow(2, lowAddressBits)) + this.addressLow
+    );
+  }
+
+  get func(): string {
+    return this.pool.getString(this.funcId);
+  }
+
+  get filename(): string {
+    return this.pool.getString(this.filenameId);
+  }
+
+  get fullname(): string {
+    return this.pool.getString(this.fullnameId);
+  }
+
+  get from(): string {
+    return this.pool.getString(this.fromId);
+  }
+
+  /** Converts the frame to a plain object, called by `JSON.stringify()`. */
+  toJSON(): IStackFrameInfo {
+    const frame: any = {
+      level: this.level,
+      func: this.func,
+      address: this.address,
+      filename: this.filename,
+      fullname: this.fullname,
+      line: this.line,
+      from: this.from
+    };
+    // include any properties that were added to the frame later on (e.g. the arguments and locals
+    // of an IStackFrameDetailedInfo)
+    Object.keys(this).forEach((key: string) => {
+      if (!(key in frame) && !compactFields.has(key)) {
+        frame[key] = (<any> this)[key];
+      }
+    });
+    return frame;
+  }
+}
+
+function padDigits(digits: string, length: number): string {
+  while (digits.length < length) {
+    digits = '0' + digits;
+  }
+  return digits;
+}
@@ -2,6 +2,7 @@
 // MIT License, see LICENSE file for full terms.
 
 import * as readline from 'readline';
+import * as path from 'path';
 import * as events from 'events';
 import * as stream from 'stream';
 import * as parser from './mi_output_parser';
@@ -11,15 +12,33 @@ import * as Events from './events';
 import {
   IBreakpointInfo, IBreakpointLocationInfo,
   IStackFrameInfo, IStackFrameArgsInfo, IStackFrameVariablesInfo, IVariableInfo,
-  IWatchInfo, IWatchUpdateInfo, IWatchChildInfo, IMemoryBlock, IAsmInstruction, ISourceLineAsm,
-  IThreadFrameInfo, IThreadInfo, IMultiThreadInfo,
+  IWatchInfo, IWatchUpdateInfo, IWatchChildInfo, IMemoryBlock, IMemoryBuffer, IAsmInstruction,
+  ISourceLineAsm, IThreadFrameInfo, IThreadInfo, IMultiThreadInfo, IStackFrameDetailedInfo,
+  IThreadSnapshot, IMemoryRegionSnapshot, IProcessSnapshot, IThreadStackInfo,
+  IBreakpointState, IWatchState, ISessionState, ISessionStateImportResult,
+  IAttachInfo, IDetachInfo, IWatchSpec, IWatchCreationResult, IWatchChildRange,
+  IExpressionSpec, IExpressionResult,
   VariableDetailLevel, WatchFormatSpec, WatchAttribute, RegisterValueFormatSpec
 } from './types';
 import {
-  extractBreakpointInfo, extractStackFrameInfo, extractWatchChildren, extractAsmInstructions,
-  extractAsmBySourceLine, extractThreadInfo
+  extractBreakpointInfo, extractStackFrameInfo, extractWatchChild, extractWatchChildren,
+  extractAsmInstructions, extractAsmBySourceLine, extractThreadInfo, extractStackFrames,
+  extractStackFrameArgs, extractMemoryBlocks, IExtractorOptions
 } from './extractors';
 import { CommandFailedError, MalformedResponseError } from './errors';
+import { TranscriptRecorder } from './transcript';
+import { WatchTree } from './watch_tree';
+import { WatchHandle, WatchScope, WatchHandleRegistry, IWatchHandleOptions } from './watch_handles';
+import { formatIntegerValue, isFormattableIntegerType } from './value_formats';
+import { StackFrameIterator, IStackFrameIteratorOptions } from './stack_frame_iterator';
+import { BacktraceCache, IBacktraceCacheStats } from './backtrace_cache';
+import { StringPool } from './string_pool';
+import { Address } from './address';
+import { parseMemoryBytesResponse } from './memory_response_parser';
+import { MemoryPageCache, IMemoryPageCacheStats } from './memory_page_cache';
+import {
+  WatchSubscriptionManager, WatchUpdateListener, IWatchSubscription
+} from './watch_subscriptions';
 
 // aliases
 type ReadLine = readline.ReadLine;
@@ -35,6 +54,16 @@ class DebugCommand {
   text: string;
   /** Optional callback to invoke once a response is received for the command. */
   done: ErrDataCallback;
+  /**
+   * If `true` the command may be sent to the debugger before responses are received for
+   * the (likewise pipelined) commands that were sent ahead of it.
+   */
+  isPipelined: boolean;
+  /**
+   * Optional function that parses the response to the command faster than the MI Output parser,
+   * it should return `undefined` for any line it can't parse.
+   */
+  parseResponse: (line: string) => { recordType: RecordType; data: any };
 
   /**
    * @param cmd MI command string (minus the token and dash prefix).
@@ -45,6 +74,8 @@ class DebugCommand {
     this.token = token;
     this.text = cmd;
     this.done = done;
+    this.isPipelined = false;
+    this.parseResponse = null;
   }
 }
 
@@ -52,9 +83,10 @@ class DebugCommand {
  * A debug session provides two-way communication with a debugger process via the GDB/LLDB
  * machine interface.
  *
- * Currently commands are queued and executed one at a time in the order they are issued,
- * a command will not be executed until all the previous commands have been acknowledged by the
- * debugger.
+ * Commands are queued and executed in the order they are issued, by default a command will not
+ * be executed until all the previous commands have been acknowledged by the debugger. Independent
+ * commands can be issued via [[pipelineCommands]], in which case they'll be sent to the debugger
+ * without waiting for the responses to the commands ahead of them.
  *
  * Out of band notifications from the debugger are emitted via events, the names of these events
  * are provided by the EVENT_XXX static constants.
@@ -68,12 +100,137 @@ export default class DebugSession extends events.EventEmitter {
   // FIXME: this is currently unused since I need to decide if tokens should be auto-generated
   // when the user doesn't supply them.
   private nextCmdId: number;
-  // commands to be processed (one at a time)
+  // commands to be processed (one at a time, unless they're pipelined)
   private cmdQueue: DebugCommand[];
+  // number of commands at the front of the queue that have been sent to the debugger but have
+  // not been acknowledged yet
+  private numCmdsInFlight: number;
+  // set while the callback passed to pipelineCommands() is running
+  private isPipeliningCommands: boolean;
   // used to to ensure session cleanup is only done once
   private cleanupWasCalled: boolean;
+  // records the MI text exchanged with the debugger (if recording is active)
+  private recorder: TranscriptRecorder;
+  // breakpoints and watches created via this session (keyed by id), used by exportState()
+  private breakpointStates: Map<number, IBreakpointState>;
+  private watchStates: Map<string, IWatchState>;
+  // total time (in milliseconds) the target has spent stopped since attachToProcess() was called,
+  // null if the debugger wasn't attached to the target via attachToProcess()
+  private attachedStoppedTime: number;
+  // when the attached target was last stopped, null if it's currently running
+  private attachedStoppedSince: [number, number];
+  private _watchTree: WatchTree;
+  private watchHandles: WatchHandleRegistry;
+  // identifiers of the watches (or children of watches) currently visible in the front-end
+  private visibleWatches: Set<string>;
+  // decimal values of integer watches retrieved since the target last stopped
+  private decimalWatchValues: Map<string, Promise<string>>;
+  private watchSubscriptions: WatchSubscriptionManager;
+  // watch updates requested while the target stop is being handled, they resolve once the
+  // changes have been applied to the watch tree (or the update failed), null the rest of the time
+  private watchUpdatesSinceStop: Promise<void>[];
+  // values of side-effect free expressions evaluated since the target last resumed execution
+  private expressionValues: Map<string, Promise<string>>;
+  // set once the Python helper has been loaded into the debugger
+  private isPythonHelperLoaded: boolean;
+  // backtraces of threads retrieved via getCachedStackFrames()
+  private backtraces: BacktraceCache;
+  // passed to the extractors of frames, threads, breakpoints, instructions and memory blocks
+  private extractorOptions: IExtractorOptions;
+  // pages of memory read via readMemory() since the target last stopped, only set if
+  // cacheMemoryReads is enabled
+  private memoryPages: MemoryPageCache;
+  // set when a *stopped notification is received, and cleared when the target resumes execution
+  // or exits, memory is only cached while this is set
+  private isTargetStopped: boolean;
   private _logger: bunyan.Logger;
 
+  /**
+   * Maximum number of pipelined commands that can be awaiting a response from the debugger
+   * at any one time, the remaining commands will be held back in the queue until some of the
+   * responses come in.
+   */
+  maxPipelinedCommands: number = 64;
+
+  /**
+   * If `true` the watches marked as visible via [[setWatchVisibility]] will be updated
+   * automatically every time the target stops, see [[updateVisibleWatches]].
+   */
+  updateVisibleWatchesOnStop: boolean = false;
+
+  /**
+   * If `true` the function names and paths in the stack frames, threads, and breakpoint locations
+   * retrieved by this debug session are interned, so there's only one copy of each distinct
+   * string no matter how many frames refer to it, and stack frames are returned as
+   * [[CompactStackFrame]] instances. This significantly reduces memory usage when a large number
+   * of frames is retained (e.g. while profiling), but the interned strings are never released
+   * until the debug session is garbage collected.
+   */
+  get internFrameStrings(): boolean {
+    return this.extractorOptions.stringPool !== undefined;
+  }
+
+  set internFrameStrings(isEnabled: boolean) {
+    if (!isEnabled) {
+      this.extractorOptions.stringPool = undefined;
+    } else if (!this.extractorOptions.stringPool) {
+      this.extractorOptions.stringPool = new StringPool();
+    }
+  }
+
+  /**
+   * If `true` the addresses in the stack frames, threads, breakpoint locations, disassembled
+   * instructions, memory blocks, and events produced by this debug session are also parsed into
+   * [[Address]] instances (e.g. [[IStackFrameInfo.numericAddress]]), which can be sorted,
+   * compared, and used in range arithmetic (see [[getRangeLength]], [[findRange]], etc.) without
+   * parsing the hex literals again.
+   */
+  get numericAddresses(): boolean {
+    return !!this.extractorOptions.numericAddresses;
+  }
+
+  set numericAddresses(isEnabled: boolean) {
+    this.extractorOptions.numericAddresses = isEnabled;
+  }
+
+  /**
+   * If `true` the memory read by [[readMemory]] from literal addresses is cached in 4 KB pages
+   * until the target resumes execution, so repeated reads of the same (or nearby) memory while
+   * the target is stopped don't need to be sent to the debugger. Reads bypass the cache until
+   * the debugger reports that the target has stopped. The cache is also invalidated when memory
+   * is written with [[writeMemory]], or a watch is modified with [[setWatchValue]], but
+   * [[invalidateMemoryCache]] must be called after any other operation that may modify the
+   * memory of the target (e.g. evaluating an expression that has side effects).
+   */
+  get cacheMemoryReads(): boolean {
+    return this.memoryPages !== null;
+  }
+
+  set cacheMemoryReads(isEnabled: boolean) {
+    if (!isEnabled) {
+      this.memoryPages = null;
+    } else if (!this.memoryPages) {
+      this.memoryPages = new MemoryPageCache((address: string, numBytesToRead: number) => {
+        return this.readMemoryChunk(address, 0, numBytesToRead);
+      });
+    }
+  }
+
+  /**
+   * Statistics that show how effective the cache enabled by [[cacheMemoryReads]] has been, or
+   * `undefined` if the cache isn't enabled.
+   */
+  get memoryCacheStats(): IMemoryPageCacheStats {
+    return this.memoryPages ? this.memoryPages.stats : undefined;
+  }
+
+  /** Discards all the memory cached by [[readMemory]], see [[cacheMemoryReads]]. */
+  invalidateMemoryCache(): void {
+    if (this.memoryPages) {
+      this.memoryPages.invalidate();
+    }
+  }
+
   get logger(): bunyan.Logger {
     return this._logger;
   }
@@ -82,6 +239,22 @@ export default class DebugSession extends events.EventEmitter {
     this._logger = logger;
   }
 
+  /**
+   * Mirrors the watches created via this debug session, along with any of their children that
+   * have been retrieved, and is kept up to date as the watches are updated.
+   */
+  get watchTree(): WatchTree {
+    return this._watchTree;
+  }
+
+  /**
+   * Number of variable objects this debug session has created that haven't been deleted yet,
+   * this includes watches as well as any of their children that have been retrieved.
+   */
+  get liveWatchCount(): number {
+    return this._watchTree.size;
+  }
+
   /**
    * In most cases [[startDebugSession]] should be used to construct new instances.
    *
@@ -98,7 +271,26 @@ export default class DebugSession extends events.EventEmitter {
     this.lineReader.on('line', this.parseDebbugerOutput.bind(this));
     this.nextCmdId = 1;
     this.cmdQueue = [];
+    this.numCmdsInFlight = 0;
+    this.isPipeliningCommands = false;
     this.cleanupWasCalled = false;
+    this.recorder = null;
+    this.breakpointStates = new Map<number, IBreakpointState>();
+    this.watchStates = new Map<string, IWatchState>();
+    this.attachedStoppedTime = null;
+    this.attachedStoppedSince = null;
+    this._watchTree = new WatchTree();
+    this.watchHandles = new WatchHandleRegistry(this);
+    this.visibleWatches = new Set<string>();
+    this.decimalWatchValues = new Map<string, Promise<string>>();
+    this.watchSubscriptions = new WatchSubscriptionManager(this);
+    this.expressionValues = new Map<string, Promise<string>>();
+    this.isPythonHelperLoaded = false;
+    this.backtraces = new BacktraceCache(this);
+    this.extractorOptions = {};
+    this.memoryPages = null;
+    this.isTargetStopped = false;
+    this.watchUpdatesSinceStop = null;
   }
 
   /**
@@ -114,7 +306,8 @@ export default class DebugSession extends events.EventEmitter {
       var cleanup = (err: Error, data: any) => {
         this.cleanupWasCalled = true;
         this.lineReader.close();
-        err ? reject(err) : resolve();
+        this.stopRecording()
+        .then(() => { err ? reject(err) : resolve(); }, reject);
       };
 
       if (!this.cleanupWasCalled) {
@@ -124,6 +317,40 @@ export default class DebugSession extends events.EventEmitter {
     });
   }
 
+  /**
+   * Starts recording the raw MI text exchanged with the debugger.
+   *
+   * Every line sent to or received from the debugger is written to the transcript file along with
+   * the time (relative to the start of the recording) at which it was sent or received. The
+   * transcript can later be played back without a debugger via [[ReplayDebugSession]], which is
+   * handy for reproducing slow sessions and for benchmarking. If a recording is already in
+   * progress it will be stopped first.
+   *
+   * @param filename Path of the file the transcript should be written to.
+   */
+  startRecording(filename: string): void {
+    this.stopRecording().catch((err: Error) => {
+      if (this.logger) {
+        this.logger.error(err, 'Failed to write out the previous transcript.');
+      }
+    });
+    this.recorder = TranscriptRecorder.createForFile(filename);
+  }
+
+  /**
+   * Stops recording the raw MI text exchanged with the debugger.
+   *
+   * @returns A promise that will be resolved once the transcript has been written out.
+   */
+  stopRecording(): Promise<void> {
+    if (this.recorder) {
+      const recorder = this.recorder;
+      this.recorder = null;
+      return recorder.end();
+    }
+    return Promise.resolve();
+  }
+
   /**
    * Returns `true` if [[EVENT_FUNCTION_FINISHED]] can be emitted during this debugging session.
    *
@@ -135,14 +362,67 @@ export default class DebugSession extends events.EventEmitter {
   }
 
   private emitExecNotification(name: string, data: any) {
-    let events = Events.createEventsForExecNotification(name, data);
+    if (this.attachedStoppedTime !== null) {
+      if ((name === 'running') && this.attachedStoppedSince) {
+        this.attachedStoppedTime += getElapsedMilliseconds(this.attachedStoppedSince);
+        this.attachedStoppedSince = null;
+      } else if ((name === 'stopped') && !this.attachedStoppedSince) {
+        this.attachedStoppedSince = process.hrtime();
+      }
+    }
+    if (name === 'stopped') {
+      this._watchTree.markStale();
+      this.watchUpdatesSinceStop = [];
+    }
+    if ((name === 'running') || (name === 'stopped')) {
+      this.isTargetStopped = (name === 'stopped');
+      this.decimalWatchValues.clear();
+      // memory read while the target was running may be out of date by the time it stops
+      this.invalidateMemoryCache();
+    }
+    if (name === 'running') {
+      this.backtraces.onTargetRunning();
+      this.watchSubscriptions.onTargetRunning();
+      this.expressionValues.clear();
+    }
+    let events = Events.createEventsForExecNotification(name, data, this.extractorOptions);
+    if (name === 'stopped') {
+      const stopEvent = <Events.ITargetStoppedEvent> events[0].data;
+      this.backtraces.onTargetStopped(stopEvent.reason, stopEvent.threadId);
+    }
     events.forEach((event: Events.IDebugSessionEvent) => {
       this.emit(event.name, event.data);
     });
+    if ((name === 'stopped') && this.updateVisibleWatchesOnStop && (this.visibleWatches.size > 0)) {
+      this.updateVisibleWatches().catch((err: Error) => {
+        if (this.logger) {
+          this.logger.error(err, 'Failed to update visible watches.');
+        }
+      });
+    }
+    if (name === 'stopped') {
+      // the subscribed watches may already be covered by the updates requested by the listeners
+      // of the stop events and updateVisibleWatches()
+      const pendingUpdates = Promise.all(this.watchUpdatesSinceStop).then(() => undefined);
+      this.watchUpdatesSinceStop = null;
+      this.watchSubscriptions.onTargetStopped(pendingUpdates).catch((err: Error) => {
+        if (this.logger) {
+          this.logger.error(err, 'Failed to notify watch subscribers.');
+        }
+      });
+    }
   }
 
   private emitAsyncNotification(name: string, data: any) {
-    let event = Events.createEventForAsyncNotification(name, data);
+    let event = Events.createEventForAsyncNotification(name, data, this.extractorOptions);
+    if (event && (event.name === Events.EVENT_THREAD_EXITED)) {
+      this.backtraces.onThreadExited((<Events.IThreadExitedEvent> event.data).id);
+    } else if (event && (event.name === Events.EVENT_THREAD_GROUP_EXITED)) {
+      // thread ids may be reused if the target is restarted
+      this.backtraces.clear();
+      this.isTargetStopped = false;
+      this.invalidateMemoryCache();
+    }
     if (event) {
       this.emit(event.name, event.data);
     } else {
@@ -156,6 +436,9 @@ export default class DebugSession extends events.EventEmitter {
    * Parse a single line containing a response to a MI command or some sort of async notification.
    */
   private parseDebbugerOutput(line: string): void {
+    if (this.recorder) {
+      this.recorder.recordOutput(line);
+    }
     // '(gdb)' (or '(gdb) ' in some cases) is used to indicate the end of a set of output lines
     // from the debugger, but since we process each line individually as it comes in this
     // particular marker is of no use
@@ -164,8 +447,16 @@ export default class DebugSession extends events.EventEmitter {
     }
 
     var cmdQueuePopped: boolean = false;
+    var result: any;
     try {
-      var result = parser.parse(line);
+      // the command at the front of the queue may be able to parse its own response faster
+      const nextCmd = this.cmdQueue[0];
+      if (nextCmd && nextCmd.parseResponse) {
+        result = nextCmd.parseResponse(line);
+      }
+      if (!result) {
+        result = parser.parse(line);
+      }
     } catch (err) {
       if (this.logger) {
         this.logger.error(err, 'Attempted to parse: ->' + line + '<-');
@@ -182,6 +473,7 @@ export default class DebugSession extends events.EventEmitter {
         // this record is a response for the last command that was sent to the debugger,
         // which is the command at the front of the queue
         var cmd = this.cmdQueue.shift();
+        this.numCmdsInFlight--;
         cmdQueuePopped = true;
         // todo: check that the token in the response matches the one sent with the command
         if (cmd.done) {
@@ -216,9 +508,9 @@ export default class DebugSession extends events.EventEmitter {
         break;
     }
 
-    // if a command was popped from the qeueu we can send through the next command
-    if (cmdQueuePopped && (this.cmdQueue.length > 0)) {
-      this.sendCommandToDebugger(this.cmdQueue[0]);
+    // if a command was popped from the qeueu we can send through the next command(s)
+    if (cmdQueuePopped) {
+      this.sendQueuedCommands();
     }
   }
 
@@ -235,21 +527,72 @@ export default class DebugSession extends events.EventEmitter {
     if (this.logger) {
       this.logger.info(cmdStr);
     }
+    if (this.recorder) {
+      this.recorder.recordCommand(cmdStr);
+    }
     this.outStream.write(cmdStr + '\n');
   }
 
+  /**
+   * Sends as many commands from the front of the queue to the debugger as possible.
+   *
+   * A command that is not pipelined will only be sent once all the commands ahead of it have been
+   * acknowledged, while a pipelined command will be sent immediately if all the commands ahead of
+   * it are likewise pipelined (and [[maxPipelinedCommands]] hasn't been reached).
+   */
+  private sendQueuedCommands(): void {
+    while (this.numCmdsInFlight < this.cmdQueue.length) {
+      const command = this.cmdQueue[this.numCmdsInFlight];
+      if (this.numCmdsInFlight > 0) {
+        const prevCommand = this.cmdQueue[this.numCmdsInFlight - 1];
+        if (!command.isPipelined || !prevCommand.isPipelined ||
+            (this.numCmdsInFlight >= this.maxPipelinedCommands)) {
+          break;
+        }
+      }
+      this.numCmdsInFlight++;
+      this.sendCommandToDebugger(command);
+    }
+  }
+
   /**
    * Adds an MI command to the back of the command queue.
    *
    * If the command queue is empty when this method is called then the command is dispatched
    * immediately, otherwise it will be dispatched after all the previously queued commands are
-   * processed.
+   * processed (or sooner if the command is pipelined).
    */
   private enqueueCommand(command: DebugCommand): void {
+    if (this.isPipeliningCommands) {
+      command.isPipelined = true;
+    }
     this.cmdQueue.push(command);
+    this.sendQueuedCommands();
+  }
 
-    if (this.cmdQueue.length === 1) {
-      this.sendCommandToDebugger(this.cmdQueue[0]);
+  /**
+   * Pipelines all the commands issued by the given function.
+   *
+   * Any commands issued synchronously by `fn` (e.g. by calling [[getStackFrames]] for multiple
+   * threads) will be sent to the debugger back to back without waiting for a response to each
+   * one, so the cost of a round trip to the debugger is only paid once for the whole batch.
+   * Commands issued after `fn` returns (for example from a `then()` callback) will not be pipelined.
+   *
+   * The debugger still executes the commands one at a time in the order they were issued, and the
+   * responses are delivered in that order, so the commands in a batch should not depend on each
+   * other's side effects (as is the case for most inspection commands). Commands that resume the
+   * inferior should not be pipelined.
+   *
+   * @param fn Function that issues the commands to be pipelined.
+   * @returns Whatever `fn` returned.
+   */
+  pipelineCommands<T>(fn: () => T): T {
+    const wasPipeliningCommands = this.isPipeliningCommands;
+    this.isPipeliningCommands = true;
+    try {
+      return fn();
+    } finally {
+      this.isPipeliningCommands = wasPipeliningCommands;
     }
   }
 
@@ -260,7 +603,7 @@ export default class DebugSession extends events.EventEmitter {
    * @param token Token to be prefixed to the command string (must consist only of digits).
    * @returns A promise that will be resolved when the command response is received.
    */
-  private executeCommand(command: string, token?: string): Promise<void> {
+  protected executeCommand(command: string, token?: string): Promise<void> {
     return new Promise<void>((resolve, reject) => {
       this.enqueueCommand(
         new DebugCommand(command, token, (err, data) => { err ? reject(err) : resolve(); })
@@ -275,24 +618,30 @@ export default class DebugSession extends events.EventEmitter {
    * @param token Token to be prefixed to the command string (must consist only of digits).
    * @param transformOutput This function will be invoked with the output of the MI Output parser
    *                        and should transform that output into an instance of type `T`.
+   * @param parseResponse Optional function that parses the response faster than the MI Output
+   *                      parser, see [[DebugCommand.parseResponse]].
    * @returns A promise that will be resolved when the command response is received.
    */
-  private getCommandOutput<T>(command: string, token?: string, transformOutput?: (data: any) => T)
-    : Promise<T> {
+  private getCommandOutput<T>(
+    command: string, token?: string, transformOutput?: (data: any) => T,
+    parseResponse?: (line: string) => { recordType: RecordType; data: any }
+  ): Promise<T> {
     return new Promise<T>((resolve, reject) => {
-      this.enqueueCommand(
-        new DebugCommand(command, token, (err, data) => {
-          if (err) {
+      const cmd = new DebugCommand(command, token, (err, data) => {
+        if (err) {
+          reject(err);
+        } else {
+          try {
+            resolve(transformOutput ? transformOutput(data) : data);
+          } catch (err) {
             reject(err);
-          } else {
-            try {
-              resolve(transformOutput ? transformOutput(data) : data);
-            } catch (err) {
-              reject(err);
-            }
           }
-        })
-      );
+        }
+      });
+      if (parseResponse) {
+        cmd.parseResponse = parseResponse;
+      }
+      this.enqueueCommand(cmd);
     });
   }
 
@@ -332,6 +681,112 @@ export default class DebugSession extends events.EventEmitter {
     return this.executeCommand(`target-select remote ${host}:${port}`);
   }
 
+  /**
+   * *(GDB specific)* Loads a core dump for post-mortem debugging.
+   *
+   * Once the core dump is loaded the state of the crashed process can be examined with the usual
+   * stack, thread, and data inspection commands, or all at once with [[getProcessSnapshot]].
+   *
+   * @param executableFile Full path to the executable that produced the core dump, the symbol
+   *                       table will also be read from this file.
+   * @param coreFile Full path to the core dump.
+   */
+  loadCoreFile(executableFile: string, coreFile: string): Promise<void> {
+    // the debugger executes these in order, so there's no need to wait for the symbols to load
+    // before asking for the core dump to be loaded
+    return this.pipelineCommands(() => Promise.all([
+      this.setExecutableFile(executableFile),
+      this.executeCommand(`target-select core ${coreFile}`)
+    ]))
+    .then(() => {});
+  }
+
+  /**
+   * Attaches the debugger to a process that's already running.
+   *
+   * When the debugger attaches to a process the debugger will emit [[EVENT_THREAD_GROUP_STARTED]],
+   * and [[EVENT_THREAD_CREATED]] for each of the threads in the process. By default the process
+   * will be stopped once the debugger attaches to it, and will remain stopped until it's resumed
+   * or the debugger detaches from it, the time the process spent stopped is reported by [[detach]].
+   *
+   * @param pid Identifier of the process to attach to.
+   * @param options.skipSymbols *(GDB specific)* If `true` the debugger will not read the symbols
+   *                            of the shared libraries loaded by the process, which can
+   *                            drastically reduce the time it takes to attach. Note that this
+   *                            setting remains in effect for the rest of the debug session.
+   * @param options.nonStop *(GDB specific)* If `true` the debugger will be switched to non-stop
+   *                        mode and the threads in the process will not be stopped when the
+   *                        debugger attaches to it, individual threads can then be interrupted
+   *                        (and resumed) without affecting the other threads. Note that non-stop
+   *                        mode must be enabled before the debugger attaches to any process.
+   * @returns A promise that will be resolved once the debugger is attached to the process.
+   */
+  attachToProcess(pid: number, options?: { skipSymbols?: boolean; nonStop?: boolean })
+    : Promise<IAttachInfo> {
+    const nonStop = options && options.nonStop;
+    let threadGroup: string;
+    const onThreadGroupStarted = (e: Events.IThreadGroupStartedEvent) => {
+      if (parseInt(e.pid, 10) === pid) {
+        threadGroup = e.id;
+      }
+    };
+    this.on(Events.EVENT_THREAD_GROUP_STARTED, onThreadGroupStarted);
+    const startTime = process.hrtime();
+    // none of these commands depend on the responses to the previous ones, so don't wait for them
+    return this.pipelineCommands(() => {
+      const commandsDone: Promise<void>[] = [];
+      if (options && options.skipSymbols) {
+        commandsDone.push(this.executeCommand('gdb-set auto-solib-add off'));
+      }
+      if (nonStop) {
+        commandsDone.push(this.executeCommand('gdb-set target-async on'));
+        commandsDone.push(this.executeCommand('gdb-set non-stop on'));
+      }
+      commandsDone.push(
+        this.executeCommand(`target-attach ${pid}` + (nonStop ? ' &' : ''))
+        .then(() => {
+          this.attachedStoppedTime = 0;
+          // in all-stop mode the process is stopped by the attach itself, and there's no telling
+          // exactly when that happens, so err on the side of caution
+          this.attachedStoppedSince = nonStop ? null : startTime;
+        })
+      );
+      return Promise.all(commandsDone);
+    })
+    .then(
+      () => {
+        this.removeListener(Events.EVENT_THREAD_GROUP_STARTED, onThreadGroupStarted);
+        return {
+          pid: pid,
+          threadGroup: threadGroup,
+          attachTime: getElapsedMilliseconds(startTime)
+        };
+      },
+      (err: Error) => {
+        this.removeListener(Events.EVENT_THREAD_GROUP_STARTED, onThreadGroupStarted);
+        throw err;
+      }
+    );
+  }
+
+  /**
+   * Detaches the debugger from the process it's attached to, the process will keep running.
+   *
+   * @returns A promise that will be resolved once the debugger is detached from the process.
+   */
+  detach(): Promise<IDetachInfo> {
+    return this.executeCommand('target-detach')
+    .then(() => {
+      let stoppedTime = this.attachedStoppedTime;
+      if ((stoppedTime !== null) && this.attachedStoppedSince) {
+        stoppedTime += getElapsedMilliseconds(this.attachedStoppedSince);
+      }
+      this.attachedStoppedTime = null;
+      this.attachedStoppedSince = null;
+      return { stoppedTime: (stoppedTime !== null) ? stoppedTime : undefined };
+    });
+  }
+
   //
   // Breakpoint Commands
   //
@@ -404,14 +859,50 @@ export default class DebugSession extends events.EventEmitter {
       }
     }
 
-    return this.getCommandOutput<IBreakpointInfo>(cmd + ' ' + location, null, extractBreakpointInfo);
+    return this.getCommandOutput<IBreakpointInfo>(
+      cmd + ' ' + location, null,
+      (output: any) => extractBreakpointInfo(output, this.extractorOptions)
+    )
+    .then((info: IBreakpointInfo) => {
+      // temporary breakpoints don't outlive the next stop so there's no point restoring them
+      if (!options || !options.isTemp) {
+        this.breakpointStates.set(info.id, {
+          location: location,
+          options: {
+            isHardware: options ? options.isHardware : undefined,
+            isPending: options ? options.isPending : undefined,
+            isDisabled: options ? options.isDisabled : undefined,
+            isTracepoint: options ? options.isTracepoint : undefined,
+            condition: options ? options.condition : undefined,
+            ignoreCount: options ? options.ignoreCount : undefined,
+            threadId: options ? options.threadId : undefined
+          }
+        });
+      }
+      return info;
+    });
+  }
+
+  /**
+   * Applies a change to the recorded state of some breakpoints (if they were created via
+   * this session).
+   */
+  private updateBreakpointStates(
+    breakIds: number[], update: (state: IBreakpointState) => void): void {
+    breakIds.forEach((breakId: number) => {
+      const state = this.breakpointStates.get(breakId);
+      if (state) {
+        update(state);
+      }
+    });
   }
 
   /**
    * Removes a breakpoint.
    */
   removeBreakpoint(breakId: number): Promise<void> {
-    return this.executeCommand('break-delete ' + breakId);
+    return this.executeCommand('break-delete ' + breakId)
+    .then(() => { this.breakpointStates.delete(breakId); });
   }
 
   /**
@@ -420,35 +911,44 @@ export default class DebugSession extends events.EventEmitter {
   removeBreakpoints(breakIds: number[]): Promise<void> {
     // FIXME: LLDB MI driver only supports removing one breakpoint at a time,
     //        so multiple breakpoints need to be removed one by one.
-    return this.executeCommand('break-delete ' + breakIds.join(' '));
+    return this.executeCommand('break-delete ' + breakIds.join(' '))
+    .then(() => {
+      breakIds.forEach((breakId: number) => { this.breakpointStates.delete(breakId); });
+    });
   }
 
   /**
    * Enables a breakpoint.
    */
   enableBreakpoint(breakId: number): Promise<void> {
-    return this.executeCommand('break-enable ' + breakId);
+    return this.enableBreakpoints([breakId]);
   }
 
   /**
    * Enables multiple breakpoints.
    */
   enableBreakpoints(breakIds: number[]): Promise<void> {
-    return this.executeCommand('break-enable ' + breakIds.join(' '));
+    return this.executeCommand('break-enable ' + breakIds.join(' '))
+    .then(() => {
+      this.updateBreakpointStates(breakIds, (state) => { state.options.isDisabled = false; });
+    });
   }
 
   /**
    * Disables a breakpoint.
    */
   disableBreakpoint(breakId: number): Promise<void> {
-    return this.executeCommand('break-disable ' + breakId);
+    return this.disableBreakpoints([breakId]);
   }
 
   /**
    * Disables multiple breakpoints.
    */
   disableBreakpoints(breakIds: number[]): Promise<void> {
-    return this.executeCommand('break-disable ' + breakIds.join(' '));
+    return this.executeCommand('break-disable ' + breakIds.join(' '))
+    .then(() => {
+      this.updateBreakpointStates(breakIds, (state) => { state.options.isDisabled = true; });
+    });
   }
 
   /**
@@ -461,8 +961,13 @@ export default class DebugSession extends events.EventEmitter {
   ignoreBreakpoint(
     breakId: number, ignoreCount: number): Promise<IBreakpointInfo> {
     return this.getCommandOutput<IBreakpointInfo>(
-      `break-after ${breakId} ${ignoreCount}`, null, extractBreakpointInfo
-    );
+      `break-after ${breakId} ${ignoreCount}`, null,
+      (output: any) => extractBreakpointInfo(output, this.extractorOptions)
+    )
+    .then((info: IBreakpointInfo) => {
+      this.updateBreakpointStates([breakId], (state) => { state.options.ignoreCount = ignoreCount; });
+      return info;
+    });
   }
 
   /**
@@ -475,7 +980,10 @@ export default class DebugSession extends events.EventEmitter {
    */
   setBreakpointCondition(
     breakId: number, condition: string): Promise<void> {
-    return this.executeCommand(`break-condition ${breakId} ${condition}`);
+    return this.executeCommand(`break-condition ${breakId} ${condition}`)
+    .then(() => {
+      this.updateBreakpointStates([breakId], (state) => { state.options.condition = condition; });
+    });
   }
 
   //
@@ -490,6 +998,16 @@ export default class DebugSession extends events.EventEmitter {
     return this.executeCommand('exec-arguments ' + args);
   }
 
+  /**
+   * *(GDB specific)* Enables or disables asynchronous execution, which allows commands to be
+   * executed while the inferior is running (e.g. [[interruptInferior]]).
+   *
+   * Should be called before the inferior is started.
+   */
+  setAsyncExecution(isEnabled: boolean): Promise<void> {
+    return this.executeCommand('gdb-set target-async ' + (isEnabled ? 'on' : 'off'));
+  }
+
   /**
    * Executes an inferior from the beginning until it exits.
    *
@@ -698,7 +1216,7 @@ export default class DebugSession extends events.EventEmitter {
     }
 
     return this.getCommandOutput(fullCmd, null, (output: any) => {
-      return extractStackFrameInfo(output.frame);
+      return extractStackFrameInfo(output.frame, this.extractorOptions);
     });
   }
 
@@ -749,7 +1267,7 @@ export default class DebugSession extends events.EventEmitter {
     var fullCmd: string = 'stack-list-frames';
     if (options) {
       if (options.threadId !== undefined) {
-        fullCmd = fullCmd + ' --thread' + options.threadId;
+        fullCmd = fullCmd + ' --thread ' + options.threadId;
       }
       if (options.noFrameFilters === true) {
         fullCmd = fullCmd + ' --no-frame-filters';
@@ -764,15 +1282,45 @@ export default class DebugSession extends events.EventEmitter {
     }
 
     return this.getCommandOutput(fullCmd, null, (output: any) => {
-      var data = output.stack.frame;
-      if (Array.isArray(data)) {
-        return data.map((frame: any) => { return extractStackFrameInfo(frame); });
-      } else {
-        return [extractStackFrameInfo(data)];
-      }
+      return extractStackFrames(output.stack, this.extractorOptions);
     });
   }
 
+  /**
+   * Creates an iterator that retrieves the frames on the stack of a thread one page at a time.
+   *
+   * This should be used instead of [[getStackFrames]] when the stack may be very deep (e.g. due
+   * to runaway recursion), retrieving hundreds of thousands of frames with a single command takes
+   * a long time and produces an enormous response.
+   *
+   * @param options See [[IStackFrameIteratorOptions]].
+   */
+  iterateStackFrames(options?: IStackFrameIteratorOptions): StackFrameIterator {
+    return new StackFrameIterator(this, options);
+  }
+
+  /**
+   * Retrieves all the frames on the stack of a thread, reusing as many frames as possible from
+   * the last time the frames of the thread were retrieved by this method.
+   *
+   * This is meant to be called after every step, since stepping usually changes only the
+   * innermost frame (or two) the debugger is asked only for as many of the innermost frames as
+   * needed to establish that the rest of the stack is unchanged. Frames are only reused after the
+   * thread finishes a step though, after any other stop (e.g. a breakpoint being hit) all the
+   * frames are retrieved again. Calling this method again before the target resumes execution
+   * doesn't send any commands to the debugger at all.
+   *
+   * @param threadId The thread for which the stack frames should be retrieved.
+   */
+  getCachedStackFrames(threadId: number): Promise<IStackFrameInfo[]> {
+    return this.backtraces.getStackFrames(threadId);
+  }
+
+  /** Statistics that show how effective [[getCachedStackFrames]] has been. */
+  get backtraceCacheStats(): IBacktraceCacheStats {
+    return this.backtraces.stats;
+  }
+
   /**
    * Retrieves a list of all the arguments for the specified frames.
    *
@@ -831,22 +1379,7 @@ export default class DebugSession extends events.EventEmitter {
     }
 
     return this.getCommandOutput(fullCmd, null, (output: any) => {
-      var data = output['stack-args'];
-      if (Array.isArray(data.frame)) {
-        // data is in the form: { frame: [{ level: 0, args: [...] }, { level: 1, args: arg1 }, ...]
-        return data.frame.map((frame: any): IStackFrameArgsInfo => {
-          return {
-            level: parseInt(frame.level, 10),
-            args: Array.isArray(frame.args) ? frame.args : [frame.args]
-          };
-        });
-      } else {
-        // data is in the form: { frame: { level: 0, args: [...] }
-        return [{
-          level: parseInt(data.frame.level, 10),
-          args: Array.isArray(data.frame.args) ? data.frame.args : [data.frame.args]
-        }];
-      }
+      return extractStackFrameArgs(output['stack-args']);
     });
   }
 
@@ -906,6 +1439,128 @@ export default class DebugSession extends events.EventEmitter {
     });
   }
 
+  /**
+   * Retrieves the frames in the given range along with their arguments (and optionally locals).
+   *
+   * This is equivalent to calling [[getStackFrames]], [[getStackFrameArgs]], and
+   * [[getStackFrameVariables]] (for each frame) and then matching up the results by frame level,
+   * except that all the commands are pipelined. When locals are requested and the range is
+   * bounded all the commands are issued in one batch, otherwise the frames are retrieved first
+   * (so the number of frames is known) and then their variables.
+   *
+   * @param options.threadId The thread for which the frames should be retrieved, defaults to the
+   *                         currently selected thread if not specified. Must be specified if
+   *                         `includeLocals` is `true`.
+   * @param options.lowFrame Level of the first frame to retrieve. *Default*: `0`.
+   * @param options.highFrame Level of the last frame to retrieve, may be larger than the actual
+   *                          number of frames on the stack. If not specified all the frames from
+   *                          `lowFrame` to the end of the stack will be retrieved.
+   * @param options.detail Specifies what information should be retrieved for each variable.
+   *                       *Default*: [[VariableDetailLevel.Simple]].
+   * @param options.includeArgs If `false` the arguments of the frames will not be retrieved
+   *                            (unless `includeLocals` is `true`). *Default*: `true`.
+   * @param options.includeLocals If `true` the local variables of each frame will be retrieved
+   *                              too. *Default*: `false`.
+   * @param options.noFrameFilters *(GDB specific)* If `true` the Python frame filters will not be
+   *                               executed.
+   * @param options.skipUnavailable If `true` information about variables that are not available
+   *                                will not be retrieved.
+   */
+  getStackFramesDetailed(
+    options?: {
+      threadId?: number;
+      lowFrame?: number;
+      highFrame?: number;
+      detail?: VariableDetailLevel;
+      includeArgs?: boolean;
+      includeLocals?: boolean;
+      noFrameFilters?: boolean;
+      skipUnavailable?: boolean;
+    }
+  ): Promise<IStackFrameDetailedInfo[]> {
+    const threadId = options ? options.threadId : undefined;
+    const lowFrame = (options && options.lowFrame) || 0;
+    const highFrame = options ? options.highFrame : undefined;
+    const detail = (options && (options.detail !== undefined)) ? options.detail : VariableDetailLevel.Simple;
+    const includeArgs = !options || (options.includeArgs !== false);
+    const includeLocals = !!(options && options.includeLocals);
+    const noFrameFilters = options ? options.noFrameFilters : undefined;
+    const skipUnavailable = options ? options.skipUnavailable : undefined;
+    if (includeLocals && (threadId === undefined)) {
+      throw new Error("threadId option must be provided to getStackFramesDetailed() if includeLocals option is used.");
+    }
+    // a range can't be open-ended, so to retrieve the frames from lowFrame to the end of the stack
+    // all the frames are retrieved and the innermost ones are discarded
+    const range = (highFrame !== undefined) ? { lowFrame, highFrame } : {};
+    const discardInnerFrames = (frames: IStackFrameDetailedInfo[]) =>
+      ((highFrame === undefined) && (lowFrame > 0)) ?
+        frames.filter((frame: IStackFrameDetailedInfo) => frame.level >= lowFrame) : frames;
+    const getVariables = (frameLevel: number) => this.getStackFrameVariables(
+      detail, { threadId, frameLevel, noFrameFilters, skipUnavailable }
+    );
+    const assignVariables = (
+      frames: IStackFrameDetailedInfo[], variables: IStackFrameVariablesInfo[]
+    ) => {
+      frames.forEach((frame: IStackFrameDetailedInfo, i: number) => {
+        frame.args = variables[i].args;
+        frame.locals = variables[i].locals;
+      });
+      return frames;
+    };
+
+    if (!includeLocals) {
+      return this.pipelineCommands(() => Promise.all([
+        this.getStackFrames(Object.assign({ threadId, noFrameFilters }, range)),
+        includeArgs ?
+          this.getStackFrameArgs(
+            detail, Object.assign({ threadId, noFrameFilters, skipUnavailable }, range)
+          ) :
+          Promise.resolve<IStackFrameArgsInfo[]>(null)
+      ]))
+      .then(([allFrames, frameArgs]) => {
+        const frames = discardInnerFrames(allFrames);
+        if (frameArgs) {
+          assignFrameArgs(frames, frameArgs);
+        }
+        return frames;
+      });
+    }
+
+    if ((highFrame !== undefined) && ((highFrame - lowFrame) < this.maxPipelinedCommands)) {
+      // the number of frames is bounded, so the variables can be requested along with the frames,
+      // requests for levels past the end of the stack will fail but that's of no consequence
+      return this.pipelineCommands(() => {
+        const framesRetrieved = this.getStackFrames({
+          threadId, noFrameFilters, lowFrame, highFrame
+        });
+        const variablesRetrieved: Promise<IStackFrameVariablesInfo | Error>[] = [];
+        for (let level = lowFrame; level <= highFrame; ++level) {
+          variablesRetrieved.push(getVariables(level).catch((err: Error) => err));
+        }
+        return Promise.all([framesRetrieved, Promise.all(variablesRetrieved)]);
+      })
+      .then(([frames, results]) => {
+        const variables = frames.map((frame: IStackFrameDetailedInfo) => {
+          const result = results[frame.level - lowFrame];
+          if (result instanceof Error) {
+            throw result;
+          }
+          return <IStackFrameVariablesInfo> result;
+        });
+        return assignVariables(frames, variables);
+      });
+    }
+
+    return this.getStackFrames(Object.assign({ threadId, noFrameFilters }, range))
+    .then((allFrames: IStackFrameDetailedInfo[]) => {
+      const frames = discardInnerFrames(allFrames);
+      return this.pipelineCommands(() => Promise.all(
+        frames.map((frame: IStackFrameDetailedInfo) => getVariables(frame.level))
+      ))
+      .then((variables: IStackFrameVariablesInfo[]) => assignVariables(frames, variables));
+    });
+  }
+
   //
   // Watch Manipulation (aka Variable Objects)
   //
@@ -984,16 +1639,96 @@ export default class DebugSession extends events.EventEmitter {
         isDynamic: output.dynamic === '1',
         displayHint: output.displayhint
       };
+    })
+    .then((info: IWatchInfo) => {
+      this._watchTree.addWatch(expression, info, !!(options && options.isFloating));
+      this.watchStates.set(info.id, {
+        expression: expression,
+        options: {
+          id: (id !== '-') ? id : undefined,
+          threadId: options ? options.threadId : undefined,
+          threadGroup: options ? options.threadGroup : undefined,
+          frameLevel: options ? options.frameLevel : undefined,
+          frameAddress: options ? options.frameAddress : undefined,
+          isFloating: options ? options.isFloating : undefined
+        }
+      });
+      return info;
     });
   }
 
+  /**
+   * Creates multiple watches at once.
+   *
+   * This is equivalent to calling [[addWatch]] for each of the given watch specifications, except
+   * that all the necessary commands are pipelined, so only a single round trip to the debugger is
+   * required instead of one per watch.
+   *
+   * @param watches Expressions to watch, along with the options that would be passed to
+   *                [[addWatch]] for each expression.
+   * @returns A promise that will be resolved with the outcome of creating each watch, in the same
+   *          order as the watch specifications passed in. The promise will not be rejected if
+   *          some of the watches couldn't be created, instead the corresponding error will be
+   *          returned in place of the watch.
+   */
+  addWatches(watches: IWatchSpec[]): Promise<IWatchCreationResult[]> {
+    return this.pipelineCommands(() => Promise.all(watches.map((spec: IWatchSpec) => {
+      return this.addWatch(spec.expression, spec.options)
+      .then(
+        (watch: IWatchInfo) => ({ watch: watch, error: <Error> null }),
+        (error: Error) => ({ watch: <IWatchInfo> null, error: error })
+      );
+    })));
+  }
+
+  /**
+   * Acquires a reference-counted handle to a watch.
+   *
+   * Unlike [[addWatch]] this will not create a new watch if a handle to a watch for the same
+   * expression (and options) is already held, instead the existing watch will be shared. The
+   * watch will be destroyed once all the handles to it have been released, watches released
+   * within the same turn of the event loop are destroyed in a single pipelined batch.
+   *
+   * If [[updateWatch]] reports that a watch has become obsolete, or that a watch that's bound to
+   * a frame has gone out of scope (because the frame is gone), all the handles to that watch are
+   * released automatically.
+   *
+   * @param expression Expression to evaluate.
+   * @param options See [[addWatch]].
+   * @returns A promise that will be resolved with a new handle to the watch.
+   */
+  acquireWatch(expression: string, options?: IWatchHandleOptions): Promise<WatchHandle> {
+    return this.watchHandles.acquire(expression, options);
+  }
+
+  /**
+   * Creates a scope that can be used to acquire handles to watches via
+   * [[WatchScope.acquireWatch]], all the handles acquired via the scope can then be released at
+   * once via [[WatchScope.release]].
+   */
+  createWatchScope(): WatchScope {
+    return new WatchScope(this.watchHandles);
+  }
+
   /**
    * Destroys a previously created watch.
    *
+   * The watch is forgotten by the session even if the debugger fails to delete it (e.g. because
+   * the debugger has already discarded an obsolete watch), the promise is still rejected though.
+   *
    * @param id Identifier of the watch to destroy.
    */
   removeWatch(id: string): Promise<void> {
-    return this.executeCommand('var-delete ' + id);
+    const forgetWatch = () => {
+      this.watchStates.delete(id);
+      this.visibleWatches.delete(id);
+      this._watchTree.removeWatch(id);
+    };
+    return this.executeCommand('var-delete ' + id)
+    .then(forgetWatch, (err: Error) => {
+      forgetWatch();
+      throw err;
+    });
   }
 
   /**
@@ -1008,7 +1743,7 @@ export default class DebugSession extends events.EventEmitter {
     }
     fullCmd = fullCmd + ' ' + id;
 
-    return this.getCommandOutput(fullCmd, null, (output: any) => {
+    const update = this.getCommandOutput(fullCmd, null, (output: any) => {
       return output.changelist.map((data: any) => {
         return {
           id: data.name,
@@ -1021,9 +1756,137 @@ export default class DebugSession extends events.EventEmitter {
           isDynamic: data.dynamic === '1',
           displayHint: data.displayhint,
           hasMoreChildren: data.has_more === '1',
-          newChildren: data.new_children
+          newChildren: Array.isArray(data.new_children) ?
+            data.new_children.map((child: any) => extractWatchChild(child)) : undefined
         };
       });
+    })
+    .then((updates: IWatchUpdateInfo[]) => {
+      this._watchTree.applyUpdates(updates);
+      this._watchTree.markFresh((id !== '*') ? id : undefined);
+      return updates;
+    });
+    if (this.watchUpdatesSinceStop) {
+      this.watchUpdatesSinceStop.push(update.then(() => undefined, () => undefined));
+    }
+    return update;
+  }
+
+  /**
+   * Freezes or unfreezes a watch.
+   *
+   * A frozen watch (along with all its children) is not updated when its parent (or `*`) is
+   * passed to [[updateWatch]], it can only be updated by passing its own identifier to
+   * [[updateWatch]]. Freezing watches that are expensive to evaluate, or are unlikely to change,
+   * reduces the time it takes to update the rest. See also [[WatchFreezePolicy]].
+   *
+   * @param id Identifier of the watch (or child) to freeze or unfreeze.
+   * @param isFrozen `true` to freeze the watch, `false` to unfreeze it.
+   */
+  setWatchFrozen(id: string, isFrozen: boolean): Promise<void> {
+    return this.executeCommand(`var-set-frozen ${id} ${isFrozen ? 1 : 0}`)
+    .then(() => {
+      this._watchTree.setFrozen(id, isFrozen);
+    });
+  }
+
+  /**
+   * Limits the children of a dynamic watch that will be updated by [[updateWatch]].
+   *
+   * This only affects watches that rely on Python-based visualizers, [[updateWatch]] will only
+   * report changes to the children of such a watch within the given range.
+   *
+   * @param id Identifier of the watch.
+   * @param from Zero-based index of the first child to update, if less than zero the range is
+   *             reset and all children will be updated.
+   * @param to Zero-based index +1 of the last child to update, if less than zero the range is
+   *           reset and all children will be updated.
+   */
+  setWatchUpdateRange(id: string, from: number, to: number): Promise<void> {
+    return this.executeCommand(`var-set-update-range ${id} ${from} ${to}`);
+  }
+
+  /**
+   * Subscribes a listener to changes to a watch (or a child of a watch).
+   *
+   * Every time the target stops the session updates the subscribed watches and passes on the
+   * changes to the listeners, so listeners don't have to call [[updateWatch]] themselves. Changes
+   * retrieved by any update (e.g. [[updateVisibleWatches]]) are passed on, and subscribed watches
+   * that were already updated after the stop aren't updated again. Each watch is updated at most
+   * once per stop, no matter how many listeners are subscribed to it (or to its ancestors), and
+   * obsolete watches aren't updated at all.
+   *
+   * @param id Identifier of the watch (or child).
+   * @param listener Function that will be invoked with each change to the watch, or to any of its
+   *                 children.
+   * @returns A subscription that can be used to unsubscribe the listener.
+   */
+  subscribeWatch(id: string, listener: WatchUpdateListener): IWatchSubscription {
+    return this.watchSubscriptions.subscribe(id, listener);
+  }
+
+  /**
+   * Marks a watch (or a child of a watch) as visible or hidden in the front-end.
+   *
+   * Updating every watch after each stop (via `updateWatch('*')`) requires the debugger to
+   * reevaluate all the watches and all their retrieved children, even the ones that are
+   * collapsed or scrolled out of view. Front-ends that keep track of what's visible can instead
+   * call [[updateVisibleWatches]] (or set [[updateVisibleWatchesOnStop]]) so that the cost of
+   * each stop depends only on what's on screen. Watches that haven't been updated since the
+   * target last stopped are marked as stale in the [[watchTree]].
+   *
+   * @param id Identifier of the watch (or child).
+   * @param isVisible `true` if the watch is visible, `false` if it's hidden.
+   * @returns A promise that will be resolved with the changes to the watch if it was stale and
+   *          had to be brought up to date (because it became visible), or with an empty list.
+   */
+  setWatchVisibility(id: string, isVisible: boolean): Promise<IWatchUpdateInfo[]> {
+    if (!isVisible) {
+      this.visibleWatches.delete(id);
+      return Promise.resolve([]);
+    }
+    this.visibleWatches.add(id);
+    const node = this._watchTree.getNode(id);
+    if (node && node.isStale) {
+      return this.updateWatch(id, VariableDetailLevel.All);
+    }
+    return Promise.resolve([]);
+  }
+
+  /**
+   * Updates the watches marked as visible via [[setWatchVisibility]], along with any of their
+   * children that have been retrieved.
+   *
+   * All the necessary commands are pipelined, and visible children whose ancestors are also
+   * visible are not updated separately.
+   *
+   * @param detail Specifies what information should be retrieved for the watches,
+   *               *Default*: [[VariableDetailLevel.All]].
+   * @returns A promise that will be resolved with the combined changelist of all the updated
+   *          watches.
+   */
+  updateVisibleWatches(detail: VariableDetailLevel = VariableDetailLevel.All)
+    : Promise<IWatchUpdateInfo[]> {
+    const ids: string[] = [];
+    this.visibleWatches.forEach((id: string) => {
+      const node = this._watchTree.getNode(id);
+      if (!node) {
+        // the watch (or an ancestor of the child) was removed
+        this.visibleWatches.delete(id);
+        return;
+      }
+      for (let ancestor = node.parent; ancestor; ancestor = ancestor.parent) {
+        if (this.visibleWatches.has(ancestor.id)) {
+          return; // will be updated along with the ancestor
+        }
+      }
+      ids.push(id);
+    });
+    return Promise.all(this.pipelineCommands(
+      () => ids.map((id: string) => this.updateWatch(id, detail))
+    ))
+    .then((changelists: IWatchUpdateInfo[][]) => {
+      return changelists.reduce((all, changes) => all.concat(changes), <IWatchUpdateInfo[]> []);
     });
   }
 
@@ -1054,6 +1917,35 @@ export default class DebugSession extends events.EventEmitter {
       from?: number;
       to?: number;
     }): Promise<IWatchChildInfo[]> {
+    return this.listWatchChildren(id, options)
+    .then((range: IWatchChildRange) => range.children);
+  }
+
+  /**
+   * Retrieves a range of direct children of the specified watch.
+   *
+   * This works just like [[getWatchChildren]], but also indicates whether the watch has any more
+   * children beyond the end of the range, which is the only way to find out how many children a
+   * dynamic watch (one that relies on a Python-based visualizer) has.
+   *
+   * @param id Identifier of the watch whose children should be retrieved.
+   * @param from Zero-based index of the first child to retrieve.
+   * @param to Zero-based index +1 of the last child to retrieve.
+   * @param detail Specifies what information should be retrieved for each child,
+   *               see [[getWatchChildren]].
+   */
+  getWatchChildRange(id: string, from: number, to: number, detail?: VariableDetailLevel)
+    : Promise<IWatchChildRange> {
+    return this.listWatchChildren(id, { detail, from, to });
+  }
+
+  private listWatchChildren(
+    id: string,
+    options?: {
+      detail?: VariableDetailLevel;
+      from?: number;
+      to?: number;
+    }): Promise<IWatchChildRange> {
     var fullCmd: string = 'var-list-children';
     if (options && (options.detail !== undefined)) {
       fullCmd = fullCmd + ' ' + options.detail;
@@ -1064,7 +1956,14 @@ export default class DebugSession extends events.EventEmitter {
     }
 
     return this.getCommandOutput(fullCmd, null, (output: any) => {
-      return extractWatchChildren(output.children);
+      return {
+        children: extractWatchChildren(output.children),
+        hasMoreChildren: output.has_more === '1'
+      };
+    })
+    .then((range: IWatchChildRange) => {
+      this._watchTree.setChildren(id, range.children, (options && options.from) || 0);
+      return range;
     });
   }
 
@@ -1085,6 +1984,10 @@ export default class DebugSession extends events.EventEmitter {
       } else {
         return output.changelist[0].value; // LLDB-MI
       }
+    })
+    .then((value: string) => {
+      this._watchTree.setValue(id, value);
+      return value;
     });
   }
 
@@ -1107,6 +2010,48 @@ export default class DebugSession extends events.EventEmitter {
     });
   }
 
+  /**
+   * Retrieves the values of multiple watches in the given format.
+   *
+   * The values of integer watches are only retrieved from the debugger (in decimal format) the
+   * first time they're requested after the target stops, and are then converted to the requested
+   * format locally, so switching hundreds of watches between formats doesn't require any round
+   * trips to the debugger. The values of all other watches (and integer values that can't be
+   * converted locally) are retrieved from the debugger in the requested format, all the
+   * necessary commands are pipelined.
+   *
+   * Unlike [[setWatchValueFormat]] this doesn't change the format of the values reported by
+   * [[updateWatch]].
+   *
+   * @param ids Identifiers of the watches whose values should be retrieved.
+   * @param formatSpec The output format for the watch values.
+   * @returns A promise that will be resolved with the values of the watches, in the same order
+   *          as the given watch identifiers.
+   */
+  getWatchValues(ids: string[], formatSpec: WatchFormatSpec): Promise<string[]> {
+    return Promise.all(this.pipelineCommands(() => ids.map((id: string) => {
+      const node = this._watchTree.getNode(id);
+      const typeName = node ? node.expressionType : undefined;
+      if (!isFormattableIntegerType(typeName)) {
+        return this.getWatchValue(id, formatSpec);
+      }
+      let decimalValue = this.decimalWatchValues.get(id);
+      if (!decimalValue) {
+        decimalValue = this.getWatchValue(id, WatchFormatSpec.Decimal);
+        decimalValue.catch(() => {
+          if (this.decimalWatchValues.get(id) === decimalValue) {
+            this.decimalWatchValues.delete(id);
+          }
+        });
+        this.decimalWatchValues.set(id, decimalValue);
+      }
+      return decimalValue.then((value: string) => {
+        const formattedValue = formatIntegerValue(value, typeName, formatSpec);
+        return (formattedValue !== undefined) ? formattedValue : this.getWatchValue(id, formatSpec);
+      });
+    })));
+  }
+
   /**
    * Sets the value of the watch expression to the value of the given expression.
    *
@@ -1115,8 +2060,18 @@ export default class DebugSession extends events.EventEmitter {
    * @returns A promise that will be resolved with the new value of the watch.
    */
   setWatchValue(id: string, expression: string): Promise<string> {
+    // reads sent after this command mustn't be served from pages cached before the assignment
+    this.invalidateMemoryCache();
     return this.getCommandOutput(`var-assign ${id} "${expression}"`, null, (output: any) => {
       return output.value;
+    })
+    .then((value: string) => {
+      // the assignment may have changed the values of other watches too
+      this.decimalWatchValues.clear();
+      this.expressionValues.clear();
+      this.invalidateMemoryCache();
+      this._watchTree.setValue(id, value);
+      return value;
     });
   }
 
@@ -1183,6 +2138,64 @@ export default class DebugSession extends events.EventEmitter {
    * @returns A promise that will be resolved with the value of the expression.
    */
   evaluateExpression(
+    expression: string, options?: { threadId?: number; frameLevel?: number }): Promise<string> {
+    // the expression may have side effects
+    this.expressionValues.clear();
+    return this.sendEvaluateExpression(expression, options);
+  }
+
+  /**
+   * Evaluates multiple expressions within the target process.
+   *
+   * This is equivalent to calling [[evaluateExpression]] for each of the given expressions, except
+   * that all the necessary commands are pipelined, so only a single round trip to the debugger is
+   * required. The values of expressions marked as side-effect free are remembered until the target
+   * resumes execution (or until an expression that may have side effects is evaluated), so
+   * evaluating such an expression again in the meantime doesn't involve the debugger at all.
+   *
+   * @param expressions The expressions to evaluate.
+   * @param options See [[evaluateExpression]], the options apply to all the expressions.
+   * @returns A promise that will be resolved with the outcome of evaluating each expression, in
+   *          the same order as the expressions passed in. The promise will not be rejected if some
+   *          of the expressions couldn't be evaluated, instead the corresponding error will be
+   *          returned in place of the value.
+   */
+  evaluateExpressions(
+    expressions: IExpressionSpec[], options?: { threadId?: number; frameLevel?: number })
+    : Promise<IExpressionResult[]> {
+    const keyPrefix = options ? `${options.threadId}:${options.frameLevel}:` : '::';
+    // values can only be remembered until an expression with side effects is evaluated
+    let canMemoize = true;
+    return Promise.all(this.pipelineCommands(() => expressions.map((spec: IExpressionSpec) => {
+      let value: Promise<string>;
+      if (spec.isSideEffectFree) {
+        const key = keyPrefix + spec.expression;
+        value = this.expressionValues.get(key);
+        if (!value) {
+          value = this.sendEvaluateExpression(spec.expression, options);
+          if (canMemoize) {
+            this.expressionValues.set(key, value);
+            // don't remember failures
+            value.catch(() => {
+              if (this.expressionValues.get(key) === value) {
+                this.expressionValues.delete(key);
+              }
+            });
+          }
+        }
+      } else {
+        this.expressionValues.clear();
+        canMemoize = false;
+        value = this.sendEvaluateExpression(spec.expression, options);
+      }
+      return value.then(
+        (result: string) => ({ value: result, error: <Error> null }),
+        (error: Error) => ({ value: <string> null, error: error })
+      );
+    })));
+  }
+
+  private sendEvaluateExpression(
     expression: string, options?: { threadId?: number; frameLevel?: number }): Promise<string> {
     var fullCmd = 'data-evaluate-expression';
     if (options) {
@@ -1215,6 +2228,18 @@ export default class DebugSession extends events.EventEmitter {
    */
   readMemory(address: string, numBytesToRead: number, options?: { byteOffset?: number })
     : Promise<IMemoryBlock[]> {
+    // only memory at literal addresses can be cached, since the address an expression evaluates
+    // to may depend on the selected frame, and only while the target is stopped, since the memory
+    // of a running target may change at any time
+    const canUseCache = this.memoryPages && this.isTargetStopped &&
+      this.memoryPages.canRead(numBytesToRead);
+    const literalAddress = canUseCache ? Address.parse(address) : undefined;
+    if (literalAddress) {
+      const byteOffset = (options && options.byteOffset) || 0;
+      return this.memoryPages.read(literalAddress.add(byteOffset), numBytesToRead)
+      .then((blocks: IMemoryBlock[]) => extractMemoryBlocks(blocks, this.extractorOptions));
+    }
+
     var fullCmd = 'data-read-memory-bytes';
     if (options && options.byteOffset) {
       fullCmd = fullCmd + ' -o ' + options.byteOffset;
@@ -1223,12 +2248,143 @@ export default class DebugSession extends events.EventEmitter {
 
     return this.getCommandOutput(fullCmd, null, (output: any) => {
       if (output.memory) {
-        return output.memory;
+        return extractMemoryBlocks(output.memory, this.extractorOptions);
       }
       throw new MalformedResponseError('Expected to find "memory".', output, fullCmd);
     });
   }
 
+  /**
+   * Writes bytes to the memory of the target.
+   *
+   * @param address Address to write to, this can be a literal address (e.g. `0x00007fffffffed30`)
+   *                or an expression (e.g. `&someBuffer`) that evaluates to the desired address.
+   * @param contents Bytes to write, either in a buffer or as a hex string (e.g. `0a0b0c`).
+   * @returns A promise that will be resolved when the memory has been written.
+   */
+  writeMemory(address: string, contents: Buffer | string): Promise<void> {
+    const hexContents = (typeof contents === 'string') ? contents : contents.toString('hex');
+    // reads sent after this command mustn't be served from pages cached before the write, and the
+    // pages of reads still in progress may be read before the write, so they're discarded again
+    // once the write completes
+    this.invalidateMemoryCache();
+    return this.executeCommand(`data-write-memory-bytes "${address}" ${hexContents}`)
+    .then(() => {
+      this.invalidateMemoryCache();
+    }, (err: Error) => {
+      // some of the memory may have been written before the command failed
+      this.invalidateMemoryCache();
+      throw err;
+    });
+  }
+
+  /**
+   * Reads all accessible memory regions in the given range into buffers.
+   *
+   * Unlike [[readMemory]] the contents of the memory are decoded straight from the debugger's
+   * responses into buffers (rather than being returned as hex strings), and large ranges are read
+   * in chunks so that the debugger doesn't output a single enormous response. The chunks are
+   * pipelined, and the contiguous blocks of memory read in separate chunks are joined together.
+   *
+   * @param address Start of the range from which memory should be read, this can be a literal
+   *                address (e.g. `0x00007fffffffed30`) or an expression (e.g. `&someBuffer`) that
+   *                evaluates to the desired address.
+   * @param numBytesToRead Number of bytes that should be read.
+   * @param options.byteOffset Offset in bytes relative to `address` from which to begin reading.
+   * @param options.chunkSize Maximum number of bytes to read with each command.
+   *                          *Default*: `262144`.
+   * @returns A promise that will be resolved with a buffer for each contiguous block of accessible
+   *          memory in the range, or rejected if none of the memory in the range could be read.
+   */
+  readMemoryBuffer(
+    address: string, numBytesToRead: number, options?: { byteOffset?: number; chunkSize?: number }
+  ): Promise<IMemoryBuffer[]> {
+    const byteOffset = (options && options.byteOffset) || 0;
+    const chunkSize = (options && options.chunkSize) || (256 * 1024);
+    if (chunkSize < 1) {
+      return Promise.reject(new Error('chunkSize option must be greater than zero.'));
+    }
+    let firstError: Error = null;
+    const chunksRead = this.pipelineCommands(() => {
+      const chunks: Promise<IMemoryBuffer[]>[] = [];
+      for (let chunkStart = 0; chunkStart < numBytesToRead; chunkStart += chunkSize) {
+        chunks.push(
+          this.readMemoryChunk(
+            address, byteOffset + chunkStart, Math.min(chunkSize, numBytesToRead - chunkStart)
+          )
+          .then((blocks: IMemoryBuffer[]) => {
+            blocks.forEach((block: IMemoryBuffer) => { block.offset += chunkStart; });
+            return blocks;
+          }, (err: Error) => {
+            // the debugger fails the command if none of the memory in the chunk is accessible
+            firstError = firstError || err;
+            return <IMemoryBuffer[]> [];
+          })
+        );
+      }
+      return Promise.all(chunks);
+    });
+    return chunksRead.then((chunks: IMemoryBuffer[][]) => {
+      const blocks: IMemoryBuffer[] = [];
+      // the contents of each block, the buffers are only concatenated once all the blocks that
+      // need to be joined together have been found
+      const blockContents: Buffer[][] = [];
+      let nextOffset: number;
+      chunks.forEach((chunk: IMemoryBuffer[]) => {
+        chunk.forEach((block: IMemoryBuffer) => {
+          if ((blocks.length > 0) && (block.offset === nextOffset)) {
+            blocks[blocks.length - 1].end = block.end;
+            blockContents[blocks.length - 1].push(block.contents);
+          } else {
+            blocks.push(block);
+            blockContents.push([block.contents]);
+          }
+          nextOffset = block.offset + block.contents.length;
+        });
+      });
+      if ((blocks.length === 0) && firstError) {
+        throw firstError;
+      }
+      blocks.forEach((block: IMemoryBuffer, i: number) => {
+        if (blockContents[i].length > 1) {
+          block.contents = Buffer.concat(blockContents[i]);
+        }
+      });
+      if (this.extractorOptions.numericAddresses) {
+        blocks.forEach((block: IMemoryBuffer) => {
+          block.numericBegin = Address.parse(block.begin);
+          block.numericEnd = Address.parse(block.end);
+        });
+      }
+      return blocks;
+    });
+  }
+
+  /** Reads a single chunk of memory for [[readMemoryBuffer]]. */
+  private readMemoryChunk(address: string, byteOffset: number, numBytesToRead: number)
+    : Promise<IMemoryBuffer[]> {
+    let fullCmd = 'data-read-memory-bytes';
+    if (byteOffset) {
+      fullCmd = fullCmd + ' -o ' + byteOffset;
+    }
+    fullCmd = fullCmd + ` "${address}" ${numBytesToRead}`;
+    return this.getCommandOutput(fullCmd, null, (output: any) => {
+      if (!output.memory) {
+        throw new MalformedResponseError('Expected to find "memory".', output, fullCmd);
+      }
+      return output.memory.map((block: any): IMemoryBuffer => ({
+        begin: block.begin,
+        end: block.end,
+        // offset relative to the start of the chunk
+        offset: parseInt(block.offset, 16),
+        // the contents will still be a hex string if the response had to be handled by the
+        // MI Output parser
+        contents: (typeof block.contents === 'string') ?
+          Buffer.from(block.contents, 'hex') : block.contents
+      }));
+    }, parseMemoryBytesResponse);
+  }
+
   /**
    * Retrieves a list of register names for the current target.
    *
@@ -1327,7 +2483,7 @@ export default class DebugSession extends events.EventEmitter {
 
     return this.getCommandOutput(fullCmd, null, (output: any) => {
       if (output.asm_insns) {
-        return extractAsmInstructions(output.asm_insns);
+        return extractAsmInstructions(output.asm_insns, this.extractorOptions);
       }
       throw new MalformedResponseError('Expected to find "asm_insns".', output, fullCmd);
     });
@@ -1352,7 +2508,7 @@ export default class DebugSession extends events.EventEmitter {
 
     return this.getCommandOutput(fullCmd, null, (output: any) => {
       if (output.asm_insns) {
-        return extractAsmBySourceLine(output.asm_insns);
+        return extractAsmBySourceLine(output.asm_insns, this.extractorOptions);
       }
       throw new MalformedResponseError('Expected to find "asm_insns".', output, fullCmd);
     });
@@ -1384,7 +2540,7 @@ export default class DebugSession extends events.EventEmitter {
 
     return this.getCommandOutput(fullCmd, null, (output: any) => {
       if (output.asm_insns) {
-        return extractAsmInstructions(output.asm_insns);
+        return extractAsmInstructions(output.asm_insns, this.extractorOptions);
       }
       throw new MalformedResponseError('Expected to find "asm_insns".', output, fullCmd);
     });
@@ -1415,7 +2571,7 @@ export default class DebugSession extends events.EventEmitter {
 
     return this.getCommandOutput(fullCmd, null, (output: any) => {
       if (output.asm_insns) {
-        return extractAsmBySourceLine(output.asm_insns);
+        return extractAsmBySourceLine(output.asm_insns, this.extractorOptions);
       }
       throw new MalformedResponseError('Expected to find "asm_insns".', output, fullCmd);
     });
@@ -1429,7 +2585,7 @@ export default class DebugSession extends events.EventEmitter {
     let fullCmd = 'thread-info ' + threadId;
     return this.getCommandOutput(fullCmd, null, (output: any) => {
       if (output.threads && (output.threads.length === 1)) {
-        return extractThreadInfo(output.threads[0]);
+        return extractThreadInfo(output.threads[0], this.extractorOptions);
       }
       throw new MalformedResponseError(
         'Expected to find "threads" list with a single element.', output, fullCmd
@@ -1448,7 +2604,7 @@ export default class DebugSession extends events.EventEmitter {
       if (Array.isArray(output.threads)) {
         let currentThread: IThreadInfo;
         let threads: IThreadInfo[] = output.threads.map((data: any) => {
-          let thread: IThreadInfo = extractThreadInfo(data);
+          let thread: IThreadInfo = extractThreadInfo(data, this.extractorOptions);
           if (thread.id === currentThreadId) {
             currentThread = thread;
           }
@@ -1459,6 +2615,498 @@ export default class DebugSession extends events.EventEmitter {
       throw new MalformedResponseError('Expected to find "threads" list.', output, fullCmd);
     });
   }
+
+  //
+  // Bulk Inspection
+  //
+
+  /**
+   * Retrieves the list of optional features supported by the debugger, e.g. `python` if GDB was
+   * built with Python support.
+   *
+   * @returns A promise that will be resolved with the names of the supported features.
+   */
+  getFeatures(): Promise<string[]> {
+    return this.getCommandOutput('list-features', null, (output: any) => {
+      return Array.isArray(output.features) ? output.features : [];
+    });
+  }
+
+  /**
+   * *(GDB specific)* Loads a Python script that extends the debugger with commands that can
+   * retrieve large amounts of data in a single round trip.
+   *
+   * Once the helper is loaded [[getProcessSnapshot]] will use it to capture the frames,
+   * variables, and registers of all threads with a single command. The helper requires GDB 14
+   * or later built with Python support, if the debugger doesn't meet these requirements the
+   * helper is not loaded, and [[getProcessSnapshot]] keeps using the regular MI commands.
+   * This should be called once, right after the debug session is started.
+   *
+   * @returns A promise that will be resolved with `true` if the helper was loaded, or `false`
+   *          if the debugger doesn't support it.
+   */
+  loadPythonHelper(): Promise<boolean> {
+    // the path is embedded in an MI c-string, the source command itself takes the rest of the
+    // line verbatim so no other quoting is needed
+    const scriptPath = path.join(__dirname, '..', 'python', 'dbgmits_helper.py')
+      .replace(/[\\"]/g, '\\$&');
+    return this.getFeatures()
+    .then((features: string[]) => {
+      if (features.indexOf('python') < 0) {
+        return false;
+      }
+      return this.pipelineCommands(() => Promise.all([
+        this.executeCommand(`interpreter-exec console "source ${scriptPath}"`),
+        this.getCommandOutput('info-gdb-mi-command dbgmits-snapshot', null, (output: any) => {
+          return output.command.exists === 'true';
+        })
+      ]))
+      .then(([_, hasSnapshotCommand]) => hasSnapshotCommand);
+    })
+    .then((isLoaded: boolean) => {
+      this.isPythonHelperLoaded = isLoaded;
+      return isLoaded;
+    }, (err: Error) => {
+      if (this.logger) {
+        this.logger.warn(err, 'Failed to load the Python helper.');
+      }
+      return false;
+    });
+  }
+
+  /**
+   * Retrieves the stacks of all the threads in the target.
+   *
+   * The thread list and the stacks are retrieved with pipelined commands, but to avoid flooding
+   * the debugger (and the command queue) when there are thousands of threads no more than
+   * `concurrency` stacks are retrieved at any one time, the stack of another thread is requested
+   * as soon as the previous one arrives.
+   *
+   * Failure to retrieve the stack of any one thread doesn't fail the whole operation, instead the
+   * error is recorded in the result for that thread.
+   *
+   * @param options.maxDepth Maximum number of frames to retrieve per thread, starting with the
+   *                         innermost frame. If not specified all frames will be retrieved.
+   * @param options.includeArgs If `true` the arguments of each frame will be retrieved too.
+   * @param options.detail Specifies what information should be retrieved for each argument.
+   *                       *Default*: [[VariableDetailLevel.Simple]].
+   * @param options.concurrency Maximum number of threads whose stacks can be retrieved at the
+   *                            same time. *Default*: [[maxPipelinedCommands]].
+   * @param options.onThreadStack Callback to invoke with the stack of each thread as soon as
+   *                              it's been retrieved, so the results can be displayed before the
+   *                              stacks of all the threads have been retrieved.
+   * @returns A promise that will be resolved with the stacks of all the threads (in the order
+   *          the threads were listed by the debugger).
+   */
+  getAllThreadStacks(
+    options?: {
+      maxDepth?: number;
+      includeArgs?: boolean;
+      detail?: VariableDetailLevel;
+      concurrency?: number;
+      onThreadStack?: (stack: IThreadStackInfo) => void;
+    }
+  ): Promise<IThreadStackInfo[]> {
+    const concurrency = Math.max(1, (options && options.concurrency) || this.maxPipelinedCommands);
+    const onThreadStack = options ? options.onThreadStack : undefined;
+
+    return this.getThreads()
+    .then((threadsInfo: IMultiThreadInfo) => new Promise<IThreadStackInfo[]>((resolve, reject) => {
+      const threads = threadsInfo.all;
+      const stacks: IThreadStackInfo[] = new Array(threads.length);
+      let nextThreadIndex = 0;
+      let numPending = 0;
+      let isDone = false;
+
+      const retrieveNextStacks = () => {
+        while (!isDone && (numPending < concurrency) && (nextThreadIndex < threads.length)) {
+          const threadIndex = nextThreadIndex++;
+          ++numPending;
+          this.retrieveThreadStack(threads[threadIndex], options)
+          .then((stack: IThreadStackInfo) => {
+            --numPending;
+            stacks[threadIndex] = stack;
+            if (onThreadStack) {
+              onThreadStack(stack);
+            }
+            if (numPending + (threads.length - nextThreadIndex) === 0) {
+              isDone = true;
+              resolve(stacks);
+            } else {
+              // keep the pipeline full
+              this.pipelineCommands(retrieveNextStacks);
+            }
+          })
+          .catch((err: Error) => {
+            // the callback threw
+            isDone = true;
+            reject(err);
+          });
+        }
+      };
+
+      if (threads.length === 0) {
+        resolve(stacks);
+      } else {
+        this.pipelineCommands(retrieveNextStacks);
+      }
+    }));
+  }
+
+  /** Retrieves the stack of a single thread for [[getAllThreadStacks]]. */
+  private retrieveThreadStack(
+    thread: IThreadInfo,
+    options?: { maxDepth?: number; includeArgs?: boolean; detail?: VariableDetailLevel }
+  ): Promise<IThreadStackInfo> {
+    const maxDepth = options ? options.maxDepth : undefined;
+    const includeArgs = !!(options && options.includeArgs);
+    const detail = (options && (options.detail !== undefined)) ? options.detail : VariableDetailLevel.Simple;
+    const lowFrame = maxDepth ? 0 : undefined;
+    const highFrame = maxDepth ? maxDepth - 1 : undefined;
+    const stack: IThreadStackInfo = {
+      id: thread.id,
+      targetId: thread.targetId,
+      name: thread.name,
+      frames: []
+    };
+    return Promise.all([
+      this.getStackFrames({ threadId: thread.id, lowFrame, highFrame }),
+      includeArgs ?
+        this.getStackFrameArgs(detail, { threadId: thread.id, lowFrame, highFrame }) :
+        Promise.resolve<IStackFrameArgsInfo[]>(null)
+    ])
+    .then(([frames, frameArgs]) => {
+      stack.frames = frames;
+      if (frameArgs) {
+        assignFrameArgs(stack.frames, frameArgs);
+      }
+      return stack;
+    }, (err: Error) => {
+      stack.error = err.message;
+      return stack;
+    });
+  }
+
+  /**
+   * Captures the state of all the threads in the target in one go.
+   *
+   * This is mostly intended for batch processing of core dumps (see [[loadCoreFile]]), though it
+   * will work just as well on a live target that's currently stopped. All the commands needed to
+   * capture the snapshot are pipelined, so the number of round trips to the debugger doesn't
+   * depend on the number of threads or frames: one to list the threads, one to get their frames
+   * (and registers), and one more to get the locals of those frames. If the Python helper has
+   * been loaded (see [[loadPythonHelper]]) the frames, variables, and registers of all the threads
+   * are captured with a single command instead.
+   *
+   * Failure to retrieve the state of any one thread or memory region doesn't fail the snapshot,
+   * instead the error is recorded in the snapshot.
+   *
+   * @param options.maxFrames Maximum number of frames to capture for each thread, if omitted all
+   *                          frames will be captured.
+   * @param options.detail Specifies what information should be captured for each argument and
+   *                       local variable. *Default*: [[VariableDetailLevel.Simple]].
+   * @param options.includeLocals Set to `false` to only capture the arguments of each frame.
+   *                              *Default*: `true`.
+   * @param options.includeRegisters Set to `true` to capture the register values of the innermost
+   *                                 frame of each thread. *Default*: `false`.
+   * @param options.registerFormat Specifies how the register values should be formatted.
+   *                               *Default*: [[RegisterValueFormatSpec.Hexadecimal]].
+   * @param options.memoryRegions Memory regions whose contents should be captured.
+   * @returns A promise that will be resolved with the captured snapshot, which can be serialized
+   *          with `JSON.stringify()` or [[formatSnapshotAsNDJSON]].
+   */
+  getProcessSnapshot(
+    options?: {
+      maxFrames?: number;
+      detail?: VariableDetailLevel;
+      includeLocals?: boolean;
+      includeRegisters?: boolean;
+      registerFormat?: RegisterValueFormatSpec;
+      memoryRegions?: { address: string; length: number }[];
+    }
+  ): Promise<IProcessSnapshot> {
+    // the helper can only format register values in hex
+    const canUseHelper = this.isPythonHelperLoaded && !(options && options.includeRegisters &&
+      (options.registerFormat !== undefined) &&
+      (options.registerFormat !== RegisterValueFormatSpec.Hexadecimal));
+    if (!canUseHelper) {
+      return this.captureProcessSnapshot(options);
+    }
+    return this.captureProcessSnapshotWithHelper(options)
+    .catch((err: Error) => {
+      if (this.logger) {
+        this.logger.warn(err, 'Python helper failed to capture the snapshot.');
+      }
+      return this.captureProcessSnapshot(options);
+    });
+  }
+
+  /** Captures a process snapshot using regular MI commands, see [[getProcessSnapshot]]. */
+  private captureProcessSnapshot(
+    options?: {
+      maxFrames?: number;
+      detail?: VariableDetailLevel;
+      includeLocals?: boolean;
+      includeRegisters?: boolean;
+      registerFormat?: RegisterValueFormatSpec;
+      memoryRegions?: { address: string; length: number }[];
+    }
+  ): Promise<IProcessSnapshot> {
+    const maxFrames = options ? options.maxFrames : undefined;
+    const detail = (options && (options.detail !== undefined)) ? options.detail : VariableDetailLevel.Simple;
+    const includeLocals = !options || (options.includeLocals !== false);
+    const includeRegisters = !!(options && options.includeRegisters);
+    const registerFormat = (options && (options.registerFormat !== undefined)) ?
+      options.registerFormat : RegisterValueFormatSpec.Hexadecimal;
+    const memoryRegions = (options && options.memoryRegions) || [];
+    const lowFrame = maxFrames ? 0 : undefined;
+    const highFrame = maxFrames ? maxFrames - 1 : undefined;
+    let snapshot: IProcessSnapshot;
+    let registerNames: string[];
+
+    const recordError = (thread: IThreadSnapshot) => (err: Error) => {
+      if (!thread.errors) {
+        thread.errors = [];
+      }
+      thread.errors.push(err.message);
+    };
+
+    return this.pipelineCommands(() => Promise.all([
+      this.getThreads(),
+      includeRegisters ? this.getRegisterNames() : Promise.resolve<string[]>(null),
+      this.captureMemoryRegions(memoryRegions)
+    ]))
+    .then(([threadsInfo, names, memory]) => {
+      registerNames = names;
+      snapshot = {
+        currentThreadId: threadsInfo.current ? threadsInfo.current.id : undefined,
+        threads: threadsInfo.all.map((thread: IThreadInfo): IThreadSnapshot => ({
+          id: thread.id,
+          targetId: thread.targetId,
+          name: thread.name,
+          frames: []
+        })),
+        memory: (memory.length > 0) ? memory : undefined
+      };
+      return this.pipelineCommands(() => Promise.all(snapshot.threads.map((thread) => {
+        const framesCaptured = this.getStackFrames({ threadId: thread.id, lowFrame, highFrame })
+        .then((frames: IStackFrameInfo[]) => { thread.frames = frames; }, recordError(thread));
+
+        const argsCaptured = includeLocals ? null :
+          this.getStackFrameArgs(detail, { threadId: thread.id, lowFrame, highFrame })
+          .then(
+            (frameArgs: IStackFrameArgsInfo[]) => framesCaptured.then(() => {
+              assignFrameArgs(thread.frames, frameArgs);
+            }),
+            recordError(thread)
+          );
+
+        const registersCaptured = !includeRegisters ? null :
+          this.getRegisterValues(registerFormat, { threadId: thread.id, frameLevel: 0 })
+          .then((values: Map<number, string>) => {
+            thread.registers = {};
+            values.forEach((value: string, registerNumber: number) => {
+              // some register numbers don't map to any actual registers
+              if (registerNames[registerNumber]) {
+                thread.registers[registerNames[registerNumber]] = value;
+              }
+            });
+          }, recordError(thread));
+
+        return Promise.all([framesCaptured, argsCaptured, registersCaptured]);
+      })));
+    })
+    .then(() => {
+      if (includeLocals) {
+        return this.pipelineCommands(() => Promise.all(snapshot.threads.map((thread) => {
+          return Promise.all(thread.frames.map((frame: IStackFrameDetailedInfo) => {
+            return this.getStackFrameVariables(detail, { threadId: thread.id, frameLevel: frame.level })
+            .then((variables: IStackFrameVariablesInfo) => {
+              frame.args = variables.args;
+              frame.locals = variables.locals;
+            }, recordError(thread));
+          }));
+        })));
+      }
+    })
+    .then(() => snapshot);
+  }
+
+  /**
+   * Captures a process snapshot using the Python helper (see [[loadPythonHelper]]), only two
+   * commands are needed no matter how many threads and frames there are.
+   */
+  private captureProcessSnapshotWithHelper(
+    options?: {
+      maxFrames?: number;
+      detail?: VariableDetailLevel;
+      includeLocals?: boolean;
+      includeRegisters?: boolean;
+      memoryRegions?: { address: string; length: number }[];
+    }
+  ): Promise<IProcessSnapshot> {
+    const maxFrames = (options && options.maxFrames) || 0;
+    const detail = (options && (options.detail !== undefined)) ? options.detail : VariableDetailLevel.Simple;
+    const includeLocals = !options || (options.includeLocals !== false);
+    const includeRegisters = !!(options && options.includeRegisters);
+    const memoryRegions = (options && options.memoryRegions) || [];
+    const fullCmd = `dbgmits-snapshot ${maxFrames} ${detail} ` +
+      `${includeLocals ? 1 : 0} ${includeRegisters ? 1 : 0}`;
+
+    return this.pipelineCommands(() => Promise.all([
+      this.getThreads(),
+      this.getCommandOutput(fullCmd, null, (output: any) => {
+        try {
+          return <{ threads: IThreadSnapshot[] }> JSON.parse(output.snapshot);
+        } catch (err) {
+          throw new MalformedResponseError('Expected to find JSON in "snapshot".', output, fullCmd);
+        }
+      }),
+      this.captureMemoryRegions(memoryRegions)
+    ]))
+    .then(([threadsInfo, captured, memory]) => {
+      const capturedThreads = new Map<number, IThreadSnapshot>();
+      captured.threads.forEach((thread: IThreadSnapshot) => {
+        capturedThreads.set(thread.id, thread);
+        // the helper's JSON only contains the hex literals
+        if (this.extractorOptions.numericAddresses) {
+          thread.frames.forEach((frame: IStackFrameDetailedInfo) => {
+            frame.numericAddress = Address.parse(frame.address);
+          });
+        }
+      });
+      return {
+        currentThreadId: threadsInfo.current ? threadsInfo.current.id : undefined,
+        threads: threadsInfo.all.map((thread: IThreadInfo): IThreadSnapshot => {
+          const capturedThread = capturedThreads.get(thread.id);
+          return {
+            id: thread.id,
+            targetId: thread.targetId,
+            name: thread.name,
+            frames: capturedThread ? capturedThread.frames : [],
+            registers: capturedThread ? capturedThread.registers : undefined,
+            errors: capturedThread ? capturedThread.errors : ['Thread was not captured.']
+          };
+        }),
+        memory: (memory.length > 0) ? memory : undefined
+      };
+    });
+  }
+
+  private captureMemoryRegions(regions: { address: string; length: number }[])
+    : Promise<IMemoryRegionSnapshot[]> {
+    return Promise.all(regions.map((region): Promise<IMemoryRegionSnapshot> => {
+      return this.readMemory(region.address, region.length)
+      .then(
+        (blocks: IMemoryBlock[]) => ({ address: region.address, length: region.length, blocks }),
+        (err: Error) => ({ address: region.address, length: region.length, error: err.message })
+      );
+    }));
+  }
+
+  //
+  // Session State
+  //
+
+  /**
+   * Captures the breakpoints and watches that were created via this debug session (and have not
+   * been removed since), so they can be recreated later with [[importState]], e.g. after
+   * restarting a crashed debugger.
+   *
+   * Temporary breakpoints, and the children of watches, are not captured.
+   *
+   * @returns A snapshot of the session state that can be serialized with `JSON.stringify()`.
+   */
+  exportState(): ISessionState {
+    const state: ISessionState = { breakpoints: [], watches: [] };
+    this.breakpointStates.forEach((breakpoint: IBreakpointState) => {
+      state.breakpoints.push({
+        location: breakpoint.location,
+        options: Object.assign({}, breakpoint.options)
+      });
+    });
+    this.watchStates.forEach((watch: IWatchState) => {
+      state.watches.push({
+        expression: watch.expression,
+        options: Object.assign({}, watch.options)
+      });
+    });
+    return state;
+  }
+
+  /**
+   * Recreates the breakpoints and watches captured by [[exportState]].
+   *
+   * All the necessary commands are pipelined, so restoring a large number of breakpoints and
+   * watches doesn't require a round trip to the debugger for each one. A breakpoint or watch
+   * that can't be recreated doesn't prevent the rest from being restored, instead the failure
+   * is reported in the result.
+   *
+   * Note that breakpoints and watches get new identifiers when they're recreated, except for
+   * watches whose identifiers were explicitly specified when they were originally created.
+   *
+   * @param state Breakpoints and watches to recreate.
+   * @returns A promise that will be resolved once all the breakpoints and watches have been
+   *          recreated (or failed to be recreated).
+   */
+  importState(state: ISessionState): Promise<ISessionStateImportResult> {
+    const result: ISessionStateImportResult = {
+      breakpoints: [],
+      watches: [],
+      failedBreakpoints: [],
+      failedWatches: []
+    };
+    return this.pipelineCommands(() => Promise.all([
+      Promise.all(state.breakpoints.map((breakpoint: IBreakpointState, i: number) => {
+        return this.addBreakpoint(breakpoint.location, breakpoint.options)
+        .then(
+          (info: IBreakpointInfo) => { result.breakpoints[i] = info; },
+          (error: Error) => {
+            result.breakpoints[i] = null;
+            result.failedBreakpoints.push({ state: breakpoint, error });
+          }
+        );
+      })),
+      this.addWatches(state.watches)
+      .then((watches: IWatchCreationResult[]) => {
+        watches.forEach((created: IWatchCreationResult, i: number) => {
+          result.watches.push(created.watch);
+          if (created.error) {
+            result.failedWatches.push({ state: state.watches[i], error: created.error });
+          }
+        });
+      })
+    ]))
+    .then(() => result);
+  }
+}
+
+/**
+ * Computes the time elapsed since the given `process.hrtime()` timestamp.
+ *
+ * @returns Elapsed time in milliseconds.
+ */
+function getElapsedMilliseconds(since: [number, number]): number {
+  const elapsed = process.hrtime(since);
+  return (elapsed[0] * 1e3) + (elapsed[1] / 1e6);
+}
+
+/**
+ * Sets the `args` of each frame to the matching (by level) arguments retrieved via
+ * [[DebugSession.getStackFrameArgs]].
+ */
+function assignFrameArgs(
+  frames: IStackFrameDetailedInfo[], frameArgs: IStackFrameArgsInfo[]): void {
+  if (frames.length === 0) {
+    return;
+  }
+  const lowFrame = frames[0].level;
+  frameArgs.forEach((info: IStackFrameArgsInfo) => {
+    const frame = frames[info.level - lowFrame];
+    if (frame) {
+      frame.args = info.args;
+    }
+  });
 }
 
 /**
@@ -46,3 +46,12 @@ export class MalformedResponseError implements Error {
     this.name = "MalformedResponseError";
   }
 }
+
+/**
+ * Checks if an error was reported by the debugger because some memory couldn't be accessed (e.g.
+ * because it isn't mapped), as opposed to some other kind of failure.
+ */
+export function isMemoryAccessError(err: Error): boolean {
+  return (err instanceof CommandFailedError) &&
+    /unable to read|cannot access memory|could not read memory/i.test(err.message);
+}
@@ -2,7 +2,8 @@
 // MIT License, see LICENSE file for full terms.
 
 import { TargetStopReason, IFrameInfo, IBreakpointInfo } from './types';
-import { extractBreakpointInfo } from './extractors';
+import { extractBreakpointInfo, IExtractorOptions } from './extractors';
+import { Address } from './address';
 
 /**
   * Emitted when a thread group is added by the debugger, it's possible the thread group
@@ -340,7 +341,9 @@ export interface IDebugSessionEvent {
   data: any;
 }
 
-export function createEventsForExecNotification(notification: string, data: any): IDebugSessionEvent[] {
+export function createEventsForExecNotification(
+  notification: string, data: any, options?: IExtractorOptions
+): IDebugSessionEvent[] {
   switch (notification) {
     case 'running':
       return [{ name: EVENT_TARGET_RUNNING, data: data['thread-id'] }];
@@ -363,7 +366,7 @@ export function createEventsForExecNotification(notification: string, data: any)
             stoppedThreads: stopEvent.stoppedThreads,
             processorCore: stopEvent.processorCore,
             breakpointId: parseInt(data.bkptno, 10),
-            frame: extractFrameInfo(data.frame)
+            frame: extractFrameInfo(data.frame, options)
           };
           events.push({ name: EVENT_BREAKPOINT_HIT, data: breakpointHitEvent });
           break;
@@ -374,7 +377,7 @@ export function createEventsForExecNotification(notification: string, data: any)
             threadId: stopEvent.threadId,
             stoppedThreads: stopEvent.stoppedThreads,
             processorCore: stopEvent.processorCore,
-            frame: extractFrameInfo(data.frame)
+            frame: extractFrameInfo(data.frame, options)
           };
           events.push({ name: EVENT_STEP_FINISHED, data: stepFinishedEvent });
           break;
@@ -385,7 +388,7 @@ export function createEventsForExecNotification(notification: string, data: any)
             threadId: stopEvent.threadId,
             stoppedThreads: stopEvent.stoppedThreads,
             processorCore: stopEvent.processorCore,
-            frame: extractFrameInfo(data.frame),
+            frame: extractFrameInfo(data.frame, options),
             resultVar: data['gdb-result-var'],
             returnValue: data['return-value']
           };
@@ -424,7 +427,9 @@ export function createEventsForExecNotification(notification: string, data: any)
   }
 }
 
-export function createEventForAsyncNotification(notification: string, data: any): IDebugSessionEvent {
+export function createEventForAsyncNotification(
+  notification: string, data: any, options?: IExtractorOptions
+): IDebugSessionEvent {
   switch (notification) {
     case 'thread-group-added':
       return { name: EVENT_THREAD_GROUP_ADDED, data: data };
@@ -488,7 +493,7 @@ export function createEventForAsyncNotification(notification: string, data: any)
       return {
         name: EVENT_BREAKPOINT_MODIFIED,
         data: <IBreakpointModifiedEvent> {
-          breakpoint: extractBreakpointInfo(data)
+          breakpoint: extractBreakpointInfo(data, options)
         }
       };
 
@@ -502,8 +507,8 @@ export function createEventForAsyncNotification(notification: string, data: any)
   * Creates an object that conforms to the IFrameInfo interface from the output of the
   * MI Output parser.
   */
-function extractFrameInfo(data: any): IFrameInfo {
-  return {
+function extractFrameInfo(data: any, options: IExtractorOptions): IFrameInfo {
+  const frame: IFrameInfo = {
     func: data.func,
     args: data.args,
     address: data.addr,
@@ -511,6 +516,10 @@ function extractFrameInfo(data: any): IFrameInfo {
     fullname: data.fullname,
     line: data.line ? parseInt(data.line, 10) : undefined,
   };
+  if (options && options.numericAddresses && data.addr) {
+    frame.numericAddress = Address.parse(data.addr);
+  }
+  return frame;
 }
 
 // There are more reasons listed in the GDB/MI spec., the ones here are just the subset that's
@@ -1,29 +1,61 @@
-// Copyright (c) 2015 Vadim Macagon
+﻿// Copyright (c) 2015 Vadim Macagon
 // MIT License, see LICENSE file for full terms.
 
 import {
   IBreakpointLocationInfo, IBreakpointInfo, IStackFrameInfo, IWatchChildInfo, IAsmInstruction,
-  ISourceLineAsm, IThreadFrameInfo, IThreadInfo
+  ISourceLineAsm, IThreadFrameInfo, IThreadInfo, IVariableInfo, IStackFrameArgsInfo, IMemoryBlock
 } from './types';
+import { StringPool } from './string_pool';
+import { CompactStackFrame } from './compact_stack_frame';
+import { Address } from './address';
 
-function extractBreakpointLocationInfo(data: any): IBreakpointLocationInfo {
-  return {
+/** Options that control the form of the objects created by some of the extractors. */
+export interface IExtractorOptions {
+  /**
+   * If provided function names and paths are interned in this pool, and stack frames are
+   * created as [[CompactStackFrame]] instances.
+   */
+  stringPool?: StringPool;
+  /** If `true` addresses are parsed into [[Address]] instances, in addition to the hex literals. */
+  numericAddresses?: boolean;
+}
+
+// returns the pooled copy of a string, or the string itself if there's no pool
+function intern(value: string, options: IExtractorOptions): string {
+  return (options && options.stringPool) ? options.stringPool.intern(value) : value;
+}
+
+// parses an address if numeric addresses were requested
+function parseAddress(value: string, options: IExtractorOptions): Address {
+  return (options && options.numericAddresses && value) ? Address.parse(value) : undefined;
+}
+
+function extractBreakpointLocationInfo(
+  data: any, options: IExtractorOptions): IBreakpointLocationInfo {
+  const location: IBreakpointLocationInfo = {
     id: data['number'],
     isEnabled: (data.enabled !== undefined) ? (data.enabled === 'y') : undefined,
     address: data.addr,
-    func: data.func,
-    filename: data.file || data.filename, // LLDB MI uses non standard 'file'
-    fullname: data.fullname,
+    func: intern(data.func, options),
+    filename: intern(data.file || data.filename, options), // LLDB MI uses non standard 'file'
+    fullname: intern(data.fullname, options),
     line: parseInt(data.line, 10),
     at: data.at
   };
+  const numericAddress = parseAddress(data.addr, options);
+  if (numericAddress) {
+    location.numericAddress = numericAddress;
+  }
+  return location;
 }
 
 /**
  * Converts the output produced by the MI Output parser from the response to the
  * -break-insert and -break-after MI commands into a more useful form.
+ *
+ * @param options Controls the form of the breakpoint locations.
  */
-export function extractBreakpointInfo(data: any): IBreakpointInfo {
+export function extractBreakpointInfo(data: any, options?: IExtractorOptions): IBreakpointInfo {
   let breakpoint: any;
   let locations: IBreakpointLocationInfo[];
 
@@ -31,11 +63,12 @@ export function extractBreakpointInfo(data: any): IBreakpointInfo {
     breakpoint = data.bkpt[0];
     locations = [];
     for (let i = 1; i < data.bkpt.length; ++i) {
-      locations.push(extractBreakpointLocationInfo(data.bkpt[i]));
+      locations.push(extractBreakpointLocationInfo(data.bkpt[i], options));
     }
   } else {
     breakpoint = data.bkpt;
-    locations = (breakpoint.addr === '<PENDING>') ? [] : [extractBreakpointLocationInfo(data.bkpt)];
+    locations = (breakpoint.addr === '<PENDING>') ?
+      [] : [extractBreakpointLocationInfo(data.bkpt, options)];
   }
 
   return <IBreakpointInfo> {
@@ -63,9 +96,11 @@ export function extractBreakpointInfo(data: any): IBreakpointInfo {
 /**
  * Creates an object that conforms to the IStackFrameInfo interface from the output of the
  * MI Output parser.
+ *
+ * @param options Controls the form of the frame.
  */
-export function extractStackFrameInfo(data: any): IStackFrameInfo {
-  return {
+export function extractStackFrameInfo(data: any, options?: IExtractorOptions): IStackFrameInfo {
+  const frame: IStackFrameInfo = {
     level: parseInt(data.level, 10),
     func: data.func,
     address: data.addr,
@@ -74,6 +109,102 @@ export function extractStackFrameInfo(data: any): IStackFrameInfo {
     line: data.line ? parseInt(data.line, 10) : undefined,
     from: data.from
   };
+  if (options && options.stringPool) {
+    // compact frames always parse their addresses
+    return new CompactStackFrame(options.stringPool, frame);
+  }
+  const numericAddress = parseAddress(data.addr, options);
+  if (numericAddress) {
+    frame.numericAddress = numericAddress;
+  }
+  return frame;
+}
+
+/**
+ * Converts the output produced by the MI Output parser from the response to the
+ * -stack-list-frames MI command into a list of frames.
+ *
+ * @param data The value of the `stack` field, which is an object when the stack contains a single
+ *             frame, and an empty list when there are no frames in the requested range.
+ * @param options Controls the form of the frames.
+ */
+export function extractStackFrames(data: any, options?: IExtractorOptions): IStackFrameInfo[] {
+  const frames = data ? data.frame : undefined;
+  if (frames === undefined) {
+    return [];
+  } else if (Array.isArray(frames)) {
+    return frames.map((frame: any) => extractStackFrameInfo(frame, options));
+  } else {
+    return [extractStackFrameInfo(frames, options)];
+  }
+}
+
+/**
+ * Converts a list of variables (such as the arguments of a frame) output by the MI Output parser
+ * into a list of objects that conform to the IVariableInfo interface.
+ *
+ * When the debugger is asked for names only it outputs a list of results rather than a list of
+ * tuples (e.g. `args=[name="a",name="b"]`), which the parser turns into a single object whose
+ * `name` field is either a string or a list of strings, this function handles that case too.
+ */
+export function extractVariables(data: any): IVariableInfo[] {
+  if ((data === undefined) || (data === null)) {
+    return [];
+  } else if (Array.isArray(data)) {
+    return data.map(extractVariable);
+  } else if (Array.isArray(data.name)) {
+    return data.name.map((name: string): IVariableInfo => ({ name }));
+  } else {
+    return [extractVariable(data)];
+  }
+}
+
+function extractVariable(data: any): IVariableInfo {
+  // only include the fields the debugger actually output
+  const variable: IVariableInfo = { name: data.name };
+  if (data.value !== undefined) {
+    variable.value = data.value;
+  }
+  if (data.type !== undefined) {
+    variable.type = data.type;
+  }
+  return variable;
+}
+
+/**
+ * Converts the output produced by the MI Output parser from the response to the
+ * -stack-list-arguments MI command into a list of frame arguments.
+ *
+ * @param data The value of the `stack-args` field.
+ */
+export function extractStackFrameArgs(data: any): IStackFrameArgsInfo[] {
+  const frames = data ? data.frame : undefined;
+  if (frames === undefined) {
+    return [];
+  }
+  return (Array.isArray(frames) ? frames : [frames]).map((frame: any): IStackFrameArgsInfo => ({
+    level: parseInt(frame.level, 10),
+    args: extractVariables(frame.args)
+  }));
+}
+
+/**
+ * Converts the output produced by the MI Output parser for a single child of a variable object
+ * into an object that conforms to the IWatchChildInfo interface.
+ */
+export function extractWatchChild(data: any): IWatchChildInfo {
+  return {
+    id: data.name,
+    childCount: parseInt(data.numchild, 10),
+    value: data.value,
+    expressionType: data['type'],
+    threadId: parseInt(data['thread-id'], 10),
+    hasMoreChildren: data.has_more !== '0',
+    isDynamic: data.dynamic === '1',
+    displayHint: data.displayhint,
+    expression: data.exp,
+    isFrozen: data.frozen === '1'
+  };
 }
 
 /**
@@ -82,21 +213,6 @@ export function extractStackFrameInfo(data: any): IStackFrameInfo {
  * interface.
  */
 export function extractWatchChildren(data: any | any[]): IWatchChildInfo[] {
-  var extractWatchChild = (data: any): IWatchChildInfo => {
-    return {
-      id: data.name,
-      childCount: parseInt(data.numchild, 10),
-      value: data.value,
-      expressionType: data['type'],
-      threadId: parseInt(data['thread-id'], 10),
-      hasMoreChildren: data.has_more !== '0',
-      isDynamic: data.dynamic === '1',
-      displayHint: data.displayhint,
-      expression: data.exp,
-      isFrozen: data.frozen === '1'
-    };
-  };
-
   if ((data === undefined) || Array.isArray(data)) {
     // data will only be an array if the array is empty
     return [];
@@ -113,10 +229,13 @@ export function extractWatchChildren(data: any | any[]): IWatchChildInfo[] {
  * Converts the output produced by the MI Output parser from the response to the
  * -data-disassemble MI command into an array of objects that conform to the IAsmInstruction
  * interface.
+ *
+ * @param options Controls the form of the instructions.
  */
-export function extractAsmInstructions(data: any[]): IAsmInstruction[] {
+export function extractAsmInstructions(
+  data: any[], options?: IExtractorOptions): IAsmInstruction[] {
   return data.map((asmInstruction: any): IAsmInstruction => {
-    return {
+    const instruction: IAsmInstruction = {
       address: asmInstruction.address,
       func: asmInstruction['func-name'],
       offset: parseInt(asmInstruction.offset, 10),
@@ -124,6 +243,11 @@ export function extractAsmInstructions(data: any[]): IAsmInstruction[] {
       opcodes: asmInstruction.opcodes,
       size: parseInt(asmInstruction.size, 10)
     };
+    const numericAddress = parseAddress(asmInstruction.address, options);
+    if (numericAddress) {
+      instruction.numericAddress = numericAddress;
+    }
+    return instruction;
   });
 }
 
@@ -131,14 +255,17 @@ export function extractAsmInstructions(data: any[]): IAsmInstruction[] {
  * Converts the output produced by the MI Output parser from the response to the
  * -data-disassemble MI command into an array of objects that conform to the ISourceLineAsm
  * interface.
+ *
+ * @param options Controls the form of the instructions.
  */
-export function extractAsmBySourceLine(data: any | any[]): ISourceLineAsm[] {
+export function extractAsmBySourceLine(
+  data: any | any[], options?: IExtractorOptions): ISourceLineAsm[] {
   let extractSrcAsmLine = (data: any): ISourceLineAsm => {
     return {
       line: parseInt(data.line, 10),
       file: data.file,
       fullname: data.fullname,
-      instructions: extractAsmInstructions(data.line_asm_insn)
+      instructions: extractAsmInstructions(data.line_asm_insn, options)
     };
   };
 
@@ -158,30 +285,58 @@ export function extractAsmBySourceLine(data: any | any[]): ISourceLineAsm[] {
  * Creates an object that conforms to the IThreadFrameInfo interface from the output of the
  * MI Output parser.
  */
-function extractThreadFrameInfo(data: any): IThreadFrameInfo {
-  return {
+function extractThreadFrameInfo(data: any, options: IExtractorOptions): IThreadFrameInfo {
+  const frame: IThreadFrameInfo = {
     level: parseInt(data.level, 10),
-    func: data.func,
+    func: intern(data.func, options),
     args: data.args,
     address: data.addr,
-    filename: data.file,
-    fullname: data.fullname,
+    filename: intern(data.file, options),
+    fullname: intern(data.fullname, options),
     line: data.line ? parseInt(data.line, 10) : undefined
   };
+  const numericAddress = parseAddress(data.addr, options);
+  if (numericAddress) {
+    frame.numericAddress = numericAddress;
+  }
+  return frame;
 }
 
 /**
  * Creates an object that conforms to the IThreadInfo interface from the output of the
  * MI Output parser.
+ *
+ * @param options Controls the form of the thread's frame.
  */
-export function extractThreadInfo(data: any): IThreadInfo {
+export function extractThreadInfo(data: any, options?: IExtractorOptions): IThreadInfo {
   return {
     id: parseInt(data.id, 10),
     targetId: data['target-id'],
     name: data.name,
-    frame: extractThreadFrameInfo(data.frame),
+    frame: extractThreadFrameInfo(data.frame, options),
     isStopped: (data.state === 'stopped') ? true : ((data.state === 'running') ? false : undefined),
     processorCore: data.core,
     details: data.details
   };
 }
+
+/**
+ * Converts the output produced by the MI Output parser from the response to the
+ * -data-read-memory-bytes MI command into a list of memory blocks.
+ *
+ * @param options Controls whether the addresses of the blocks are parsed.
+ */
+export function extractMemoryBlocks(data: any[], options?: IExtractorOptions): IMemoryBlock[] {
+  if (!options || !options.numericAddresses) {
+    return data;
+  }
+  return data.map((block: any): IMemoryBlock => ({
+    begin: block.begin,
+    end: block.end,
+    offset: block.offset,
+    contents: block.contents,
+    numericBegin: Address.parse(block.begin),
+    numericEnd: Address.parse(block.end),
+    numericOffset: parseInt(block.offset, 16)
+  }));
+}
@@ -5,4 +5,22 @@ export * from './types';
 export * from './events';
 export * from './errors';
 export { default as DebugSession } from './debug_session';
+export { default as ReplayDebugSession } from './replay_debug_session';
 export * from './dbgmits';
+export * from './snapshots';
+export * from './transcript';
+export * from './watch_tree';
+export * from './watch_child_pager';
+export * from './watch_handles';
+export * from './watch_freeze_policy';
+export * from './value_formats';
+export * from './watch_subscriptions';
+export * from './stack_frame_iterator';
+export * from './backtrace_cache';
+export * from './pprof';
+export * from './sampling_profiler';
+export * from './string_pool';
+export * from './compact_stack_frame';
+export * from './address';
+export * from './memory_range_reader';
+export * from './memory_page_cache';
@@ -0,0 +1,284 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+import { Address } from './address';
+import { isMemoryAccessError } from './errors';
+import { IMemoryBlock, IMemoryBuffer } from './types';
+
+/** Statistics collected by [[MemoryPageCache]]. */
+export interface IMemoryPageCacheStats {
+  /** Number of reads that were served entirely by the pages already in the cache. */
+  hits: number;
+  /**
+   * Number of reads that required (at least some) pages to be read from the debugger, or that
+   * had to be sent to the debugger anyway because none of the memory was readable.
+   */
+  misses: number;
+  /** Fraction of reads that were hits, `0` if there haven't been any reads. */
+  hitRate: number;
+  /** Number of pages read from the debugger. */
+  pagesRead: number;
+  /** Number of pages served from the cache. */
+  pagesReused: number;
+  /** Number of times the cache was emptied because the memory may have changed. */
+  invalidations: number;
+}
+
+/** Options that can be passed to the [[MemoryPageCache]] constructor. */
+export interface IMemoryPageCacheOptions {
+  /** Size of each page in bytes, must be a power of two. *Default*: `4096`. */
+  pageSize?: number;
+  /**
+   * Maximum number of pages to keep in the cache, once the limit is reached the least recently
+   * used pages are discarded. Reads that span more pages than this bypass the cache entirely.
+   * *Default*: `1024`.
+   */
+  maxPages?: number;
+}
+
+interface IMemoryPage {
+  contents: Buffer;
+  // sorted list of the readable parts of the page as [begin, end) pairs of offsets, most pages
+  // will either be fully readable or not readable at all
+  readable: number[];
+}
+
+/** Formats an address or offset the same way the debugger does in memory blocks. */
+function formatCoreAddress(address: Address): string {
+  return '0x' + ('0000000' + address.high.toString(16)).slice(-8) +
+    ('0000000' + address.low.toString(16)).slice(-8);
+}
+
+function createMemoryBlock(address: Address, offset: number, contents: Buffer): IMemoryBlock {
+  return {
+    begin: formatCoreAddress(address.add(offset)),
+    offset: formatCoreAddress(Address.fromNumber(offset)),
+    end: formatCoreAddress(address.add(offset + contents.length)),
+    contents: contents.toString('hex')
+  };
+}
+
+/**
+ * Caches the memory read from the target in fixed size pages between stops, see
+ * [[DebugSession.cacheMemoryReads]].
+ *
+ * Memory views and tools that follow pointers tend to read many small overlapping ranges around
+ * the same addresses while the target is stopped. Each read is rounded out to whole pages, and any
+ * pages that aren't in the cache yet are read from the debugger with a single command that covers
+ * all of them. The cache must be invalidated whenever the memory of the target may have changed.
+ */
+export class MemoryPageCache {
+  // pages keyed by start address, the promise is stored so that concurrent reads of the same page
+  // only send one command, the map is kept in least recently used order
+  private pages = new Map<string, Promise<IMemoryPage>>();
+  private pageSize: number;
+  private maxPages: number;
+  private _stats = { hits: 0, misses: 0, pagesRead: 0, pagesReused: 0, invalidations: 0 };
+
+  /**
+   * @param readMemory Function that reads a range of memory from the debugger.
+   */
+  constructor(
+    private readMemory: (address: string, numBytesToRead: number) => Promise<IMemoryBuffer[]>,
+    options?: IMemoryPageCacheOptions
+  ) {
+    this.pageSize = (options && options.pageSize) || 4096;
+    this.maxPages = (options && options.maxPages) || 1024;
+  }
+
+  /** Statistics accumulated since the cache was created or [[resetStats]] was last called. */
+  get stats(): IMemoryPageCacheStats {
+    const numReads = this._stats.hits + this._stats.misses;
+    return {
+      hits: this._stats.hits,
+      misses: this._stats.misses,
+      hitRate: (numReads > 0) ? (this._stats.hits / numReads) : 0,
+      pagesRead: this._stats.pagesRead,
+      pagesReused: this._stats.pagesReused,
+      invalidations: this._stats.invalidations
+    };
+  }
+
+  /** Resets all the statistics to zero. */
+  resetStats(): void {
+    this._stats = { hits: 0, misses: 0, pagesRead: 0, pagesReused: 0, invalidations: 0 };
+  }
+
+  /**
+   * Removes all the cached pages, should be called whenever the memory of the target may have
+   * changed (e.g. when the target resumes execution, or something is written to its memory).
+   * Reads that are still in progress will complete, but their pages won't be cached.
+   */
+  invalidate(): void {
+    if (this.pages.size > 0) {
+      this.pages.clear();
+      ++this._stats.invalidations;
+    }
+  }
+
+  /** Checks if a read of the given number of bytes can be served by the cache. */
+  canRead(numBytesToRead: number): boolean {
+    return (numBytesToRead > 0) && (numBytesToRead <= ((this.maxPages - 1) * this.pageSize));
+  }
+
+  /**
+   * Reads a range of memory, see [[DebugSession.readMemory]].
+   *
+   * @returns A promise that will be resolved with a list of memory blocks that were read, or
+   *          rejected if none of the memory in the range could be read.
+   */
+  read(address: Address, numBytesToRead: number): Promise<IMemoryBlock[]> {
+    const firstPage = address.add(-(address.low % this.pageSize));
+    const firstPageOffset = address.subtract(firstPage);
+    const numPages = Math.ceil((firstPageOffset + numBytesToRead) / this.pageSize);
+    const pages: Promise<IMemoryPage>[] = [];
+    let firstMissing = -1;
+    let lastMissing = -1;
+    for (let i = 0; i < numPages; ++i) {
+      const key = firstPage.add(i * this.pageSize).toString();
+      const page = this.pages.get(key);
+      pages.push(page);
+      if (page) {
+        // move the page to the end of the map to keep it in least recently used order
+        this.pages.delete(key);
+        this.pages.set(key, page);
+      } else {
+        firstMissing = (firstMissing < 0) ? i : firstMissing;
+        lastMissing = i;
+      }
+    }
+
+    if (firstMissing < 0) {
+      this._stats.pagesReused += numPages;
+    } else {
+      ++this._stats.misses;
+      // the pages between the first and last missing page are read again even if they're already
+      // cached, it's cheaper than sending multiple commands
+      const numMissingPages = lastMissing - firstMissing + 1;
+      this._stats.pagesRead += numMissingPages;
+      this._stats.pagesReused += numPages - numMissingPages;
+      const missingPages = this.readPages(
+        firstPage.add(firstMissing * this.pageSize), numMissingPages
+      );
+      for (let i = firstMissing; i <= lastMissing; ++i) {
+        const key = firstPage.add(i * this.pageSize).toString();
+        const page = missingPages.then((readPages: IMemoryPage[]) => readPages[i - firstMissing]);
+        // pages that failed to be read for any reason other than being inaccessible aren't cached
+        page.catch(() => {
+          if (this.pages.get(key) === page) {
+            this.pages.delete(key);
+          }
+        });
+        this.pages.set(key, page);
+        pages[i] = page;
+      }
+      while (this.pages.size > this.maxPages) {
+        this.pages.delete(this.pages.keys().next().value);
+      }
+    }
+
+    return Promise.all(pages).then((readPages: IMemoryPage[]) => {
+      const blocks = this.extractBlocks(readPages, address, firstPageOffset, numBytesToRead);
+      if (firstMissing < 0) {
+        // a read of pages that are cached as unreadable still goes to the debugger (see below)
+        if (blocks.length > 0) {
+          ++this._stats.hits;
+        } else {
+          ++this._stats.misses;
+        }
+      }
+      if (blocks.length > 0) {
+        return blocks;
+      }
+      // none of the memory in the range is readable, read it again without the cache so the
+      // promise is rejected with whatever error the debugger reports
+      return this.readMemory(address.toString(), numBytesToRead)
+      .then((buffers: IMemoryBuffer[]) => buffers.map((buffer: IMemoryBuffer) => {
+        return createMemoryBlock(address, buffer.offset, buffer.contents);
+      }));
+    });
+  }
+
+  /** Reads a number of consecutive pages from the debugger. */
+  private readPages(firstPage: Address, numPages: number): Promise<IMemoryPage[]> {
+    return this.readMemory(firstPage.toString(), numPages * this.pageSize)
+    .then((blocks: IMemoryBuffer[]) => {
+      const pages: IMemoryPage[] = [];
+      let blockIndex = 0;
+      for (let i = 0; i < numPages; ++i) {
+        const pageBegin = i * this.pageSize;
+        const pageEnd = pageBegin + this.pageSize;
+        const page: IMemoryPage = { contents: null, readable: [] };
+        // skip the blocks that end before this page
+        while ((blockIndex < blocks.length) &&
+               ((blocks[blockIndex].offset + blocks[blockIndex].contents.length) <= pageBegin)) {
+          ++blockIndex;
+        }
+        for (let j = blockIndex; (j < blocks.length) && (blocks[j].offset < pageEnd); ++j) {
+          const block = blocks[j];
+          const begin = Math.max(block.offset, pageBegin);
+          const end = Math.min(block.offset + block.contents.length, pageEnd);
+          if ((begin === pageBegin) && (end === pageEnd)) {
+            // the whole page is readable, so the contents can be shared with the block
+            page.contents = block.contents.slice(begin - block.offset, end - block.offset);
+          } else {
+            page.contents = page.contents || Buffer.alloc(this.pageSize);
+            block.contents.copy(
+              page.contents, begin - pageBegin, begin - block.offset, end - block.offset
+            );
+          }
+          page.readable.push(begin - pageBegin, end - pageBegin);
+        }
+        pages.push(page);
+      }
+      return pages;
+    }, (err: Error) => {
+      if (!isMemoryAccessError(err)) {
+        throw err;
+      }
+      // none of the memory in the pages is readable
+      const pages: IMemoryPage[] = [];
+      for (let i = 0; i < numPages; ++i) {
+        pages.push({ contents: null, readable: [] });
+      }
+      return pages;
+    });
+  }
+
+  /** Extracts the readable parts of a range from the pages covering it. */
+  private extractBlocks(
+    pages: IMemoryPage[], address: Address, firstPageOffset: number, numBytesToRead: number
+  ): IMemoryBlock[] {
+    const blocks: IMemoryBlock[] = [];
+    // readable parts of the pages that form the current block
+    let pieces: Buffer[] = [];
+    let blockBegin = 0;
+    let blockEnd = 0;
+    const endBlock = () => {
+      if (pieces.length > 0) {
+        const contents = (pieces.length > 1) ? Buffer.concat(pieces) : pieces[0];
+        blocks.push(createMemoryBlock(address, blockBegin, contents));
+        pieces = [];
+      }
+    };
+    pages.forEach((page: IMemoryPage, i: number) => {
+      // offset of the page relative to the start of the range
+      const pageOffset = (i * this.pageSize) - firstPageOffset;
+      for (let j = 0; j < page.readable.length; j += 2) {
+        const begin = Math.max(pageOffset + page.readable[j], 0);
+        const end = Math.min(pageOffset + page.readable[j + 1], numBytesToRead);
+        if (begin >= end) {
+          continue;
+        }
+        if ((pieces.length === 0) || (begin !== blockEnd)) {
+          endBlock();
+          blockBegin = begin;
+        }
+        pieces.push(page.contents.slice(begin - pageOffset, end - pageOffset));
+        blockEnd = end;
+      }
+    });
+    endBlock();
+    return blocks;
+  }
+}
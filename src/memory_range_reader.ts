@@ -0,0 +1,340 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+import * as fs from 'fs';
+import * as stream from 'stream';
+import DebugSession from './debug_session';
+import { isMemoryAccessError } from './errors';
+import { IMemoryBuffer } from './types';
+
+/** Options that can be passed to the [[MemoryRangeReader]] constructor. */
+export interface IMemoryRangeReaderOptions {
+  /** Number of bytes to read with each command. *Default*: `1048576`. */
+  blockSize?: number;
+  /**
+   * Maximum number of blocks that may be read ahead of the last block written out, this bounds
+   * both the number of commands pipelined to the debugger and the amount of memory used to hold
+   * blocks that arrived before the blocks preceding them were written out. *Default*: `8`.
+   */
+  maxBlocksInFlight?: number;
+  /**
+   * Offset in bytes (relative to the start of the range) from which to begin reading, e.g. the
+   * [[IMemoryReadResult.nextOffset]] of a previous read that was stopped. *Default*: `0`.
+   */
+  startOffset?: number;
+  /**
+   * If `true` the memory that couldn't be read is written out as zeroes, so that the offset of
+   * every byte in the output matches its offset in the range. If `false` unreadable memory is
+   * simply left out of the output. *Default*: `true`.
+   */
+  fillGaps?: boolean;
+  /** Invoked each time a block has been written out. */
+  onProgress?: (progress: IMemoryReadProgress) => void;
+}
+
+/** A part of the range that couldn't be read. */
+export interface IMemoryGap {
+  /** Offset in bytes relative to the start of the range. */
+  offset: number;
+  /** Length in bytes. */
+  length: number;
+}
+
+export interface IMemoryReadProgress {
+  /** Number of bytes read so far (not including any bytes read by previous reads). */
+  bytesRead: number;
+  /** Number of bytes that couldn't be read so far. */
+  bytesUnreadable: number;
+  /** Length of the whole range in bytes. */
+  bytesTotal: number;
+  /** Offset (relative to the start of the range) up to which the output has been written. */
+  nextOffset: number;
+  /** Number of milliseconds elapsed since the read started. */
+  elapsedMs: number;
+  /** Average number of bytes read per second. */
+  bytesPerSecond: number;
+}
+
+export interface IMemoryReadResult extends IMemoryReadProgress {
+  /** Parts of the range that couldn't be read, adjacent gaps are merged. */
+  gaps: IMemoryGap[];
+  /**
+   * `false` if the read was stopped before reaching the end of the range, in which case it can be
+   * resumed from [[nextOffset]].
+   */
+  isComplete: boolean;
+}
+
+/**
+ * Reads a large range of memory from the target and writes it out (in order) to a stream or a file.
+ *
+ * The range is split up into blocks that are read with [[DebugSession.readMemoryBuffer]], several
+ * blocks are pipelined at a time so the debugger is kept busy while the previous blocks are being
+ * written out, and the output stream's backpressure is respected. Blocks (or parts of blocks) that
+ * can't be read (e.g. unmapped pages) are recorded as gaps instead of failing the whole read, but
+ * any other failure (e.g. the target resuming execution, or the session ending) fails the read.
+ *
+ * The target must remain stopped for the duration of the read.
+ */
+export class MemoryRangeReader {
+  private blockSize: number;
+  private maxBlocksInFlight: number;
+  private startOffset: number;
+  private fillGaps: boolean;
+  private onProgress: (progress: IMemoryReadProgress) => void;
+  private _isReading: boolean = false;
+  private isStopping: boolean = false;
+
+  /** `true` while a read is in progress. */
+  get isReading(): boolean {
+    return this._isReading;
+  }
+
+  /**
+   * @param debugSession Session to read memory through.
+   * @param address Start of the range, a literal address (e.g. `0x00007fffffffed30`) or an
+   *                expression that evaluates to the desired address (e.g. `&someBuffer`).
+   * @param length Length of the range in bytes.
+   */
+  constructor(
+    private debugSession: DebugSession, private address: string, private length: number,
+    options?: IMemoryRangeReaderOptions
+  ) {
+    options = options || {};
+    this.blockSize = options.blockSize || (1024 * 1024);
+    this.maxBlocksInFlight = options.maxBlocksInFlight || 8;
+    this.startOffset = options.startOffset || 0;
+    this.fillGaps = (options.fillGaps !== undefined) ? options.fillGaps : true;
+    this.onProgress = options.onProgress;
+  }
+
+  /**
+   * Stops the read in progress (if any) once the blocks that are already being read have been
+   * written out, the promise returned by the read will then be resolved with a result whose
+   * [[IMemoryReadResult.isComplete]] is `false`.
+   */
+  stop(): void {
+    if (this._isReading) {
+      this.isStopping = true;
+    }
+  }
+
+  /**
+   * Reads the range and writes it out to a stream.
+   *
+   * @param outStream Stream to write the memory to, it will not be ended once the read completes.
+   * @returns A promise that will be resolved once all the memory read has been written to the
+   *          stream, or rejected if the stream emits an error, a block fails to be read for any
+   *          reason other than the memory being inaccessible, or none of the memory could be
+   *          read.
+   */
+  readToStream(outStream: stream.Writable): Promise<IMemoryReadResult> {
+    return this.read(outStream, this.startOffset);
+  }
+
+  /**
+   * Reads the range and writes it out to a file.
+   *
+   * @param filename Path of the file to write the memory to.
+   * @param options.resume If `true` and the file already exists the read will resume from the
+   *                       end of the file (ignoring the `startOffset` option) and append to it,
+   *                       this is only possible if the `fillGaps` option is enabled. If `false`
+   *                       any existing file will be overwritten. *Default*: `false`.
+   * @returns A promise that will be resolved once the memory read has been flushed to the file.
+   */
+  readToFile(filename: string, options?: { resume?: boolean }): Promise<IMemoryReadResult> {
+    const resume = options && options.resume;
+    if (resume && !this.fillGaps) {
+      return Promise.reject(
+        new Error('Reads can only be resumed if the fillGaps option is enabled.')
+      );
+    }
+    const getStartOffset = resume ?
+      new Promise<number>((resolve, reject) => {
+        fs.stat(filename, (err, stats) => {
+          if (err && (err.code === 'ENOENT')) {
+            resolve(0);
+          } else if (err) {
+            reject(err);
+          } else {
+            resolve(stats.size);
+          }
+        });
+      }) : Promise.resolve(this.startOffset);
+
+    return getStartOffset.then((startOffset: number) => {
+      const outStream = fs.createWriteStream(filename, { flags: resume ? 'a' : 'w' });
+      const finish = () => new Promise<void>((resolve, reject) => {
+        outStream.once('error', reject);
+        outStream.end(resolve);
+      });
+      return this.read(outStream, startOffset)
+      .then(
+        (result: IMemoryReadResult) => finish().then(() => result),
+        (err: Error) => finish().then(() => { throw err; }, () => { throw err; })
+      );
+    });
+  }
+
+  private read(outStream: stream.Writable, startOffset: number): Promise<IMemoryReadResult> {
+    if (this._isReading) {
+      return Promise.reject(new Error('A read is already in progress.'));
+    }
+    this._isReading = true;
+    this.isStopping = false;
+
+    const startTime = Date.now();
+    const numBlocks = Math.max(0, Math.ceil((this.length - startOffset) / this.blockSize));
+    // blocks that have been read but not yet written out, keyed by index
+    const blocksRead = new Map<number, IMemoryBuffer[]>();
+    const gaps: IMemoryGap[] = [];
+    let nextBlockToRead = 0;
+    let nextBlockToWrite = 0;
+    let numBlocksInFlight = 0;
+    let isWaitingForDrain = false;
+    let isFinished = false;
+    let bytesRead = 0;
+    let bytesUnreadable = 0;
+    let nextOffset = Math.min(startOffset, this.length);
+    let firstReadError: Error = null;
+    // an error emitted by the stream, or a read error other than inaccessible memory
+    let fatalError: Error = null;
+
+    const getProgress = (): IMemoryReadProgress => {
+      const elapsedMs = Date.now() - startTime;
+      return {
+        bytesRead,
+        bytesUnreadable,
+        bytesTotal: this.length,
+        nextOffset,
+        elapsedMs,
+        bytesPerSecond: (elapsedMs > 0) ? (bytesRead * 1000 / elapsedMs) : 0
+      };
+    };
+
+    const addGap = (offset: number, length: number): boolean => {
+      bytesUnreadable += length;
+      const lastGap = gaps[gaps.length - 1];
+      if (lastGap && ((lastGap.offset + lastGap.length) === offset)) {
+        lastGap.length += length;
+      } else {
+        gaps.push({ offset, length });
+      }
+      return this.fillGaps ? outStream.write(Buffer.alloc(length)) : true;
+    };
+
+    return new Promise<IMemoryReadResult>((resolve, reject) => {
+      const onStreamError = (err: Error) => {
+        fatalError = fatalError || err;
+        // the stream won't drain after an error
+        if (isWaitingForDrain) {
+          isWaitingForDrain = false;
+          writeBlocks();
+        }
+      };
+      const onDrain = () => {
+        isWaitingForDrain = false;
+        writeBlocks();
+      };
+
+      const tryFinish = () => {
+        if (isFinished || isWaitingForDrain || (numBlocksInFlight > 0)) {
+          return;
+        }
+        const isComplete = (nextBlockToWrite === numBlocks);
+        if (!isComplete && !this.isStopping && !fatalError) {
+          return;
+        }
+        isFinished = true;
+        this._isReading = false;
+        this.isStopping = false;
+        outStream.removeListener('error', onStreamError);
+        outStream.removeListener('drain', onDrain);
+        if (fatalError) {
+          reject(fatalError);
+        } else if ((bytesRead === 0) && (bytesUnreadable > 0) && firstReadError) {
+          reject(firstReadError);
+        } else {
+          const progress = <IMemoryReadResult> getProgress();
+          progress.gaps = gaps;
+          progress.isComplete = isComplete;
+          resolve(progress);
+        }
+      };
+
+      // writes out the blocks that have been read in order, stopping at the first block that
+      // hasn't been read yet, or once the stream wants the writes to stop for a while
+      const writeBlocks = () => {
+        while (!isWaitingForDrain && !fatalError && blocksRead.has(nextBlockToWrite)) {
+          const blocks = blocksRead.get(nextBlockToWrite);
+          blocksRead.delete(nextBlockToWrite);
+          const blockStart = startOffset + (nextBlockToWrite * this.blockSize);
+          const blockLength = Math.min(this.blockSize, this.length - blockStart);
+          let canWrite = true;
+          let offset = 0;
+          blocks.forEach((block: IMemoryBuffer) => {
+            if (block.offset > offset) {
+              canWrite = addGap(blockStart + offset, block.offset - offset) && canWrite;
+            }
+            canWrite = outStream.write(block.contents) && canWrite;
+            bytesRead += block.contents.length;
+            offset = block.offset + block.contents.length;
+          });
+          if (offset < blockLength) {
+            canWrite = addGap(blockStart + offset, blockLength - offset) && canWrite;
+          }
+          ++nextBlockToWrite;
+          nextOffset = blockStart + blockLength;
+          if (!canWrite) {
+            isWaitingForDrain = true;
+            outStream.once('drain', onDrain);
+          }
+          if (this.onProgress) {
+            this.onProgress(getProgress());
+          }
+        }
+        if (fatalError) {
+          blocksRead.clear();
+        } else {
+          readBlocks();
+        }
+        tryFinish();
+      };
+
+      const readBlocks = () => {
+        this.debugSession.pipelineCommands(() => {
+          while (!this.isStopping && !fatalError && (nextBlockToRead < numBlocks) &&
+                 ((nextBlockToRead - nextBlockToWrite) < this.maxBlocksInFlight)) {
+            const index = nextBlockToRead++;
+            const blockStart = startOffset + (index * this.blockSize);
+            const blockLength = Math.min(this.blockSize, this.length - blockStart);
+            ++numBlocksInFlight;
+            this.debugSession.readMemoryBuffer(
+              this.address, blockLength, { byteOffset: blockStart, chunkSize: blockLength }
+            )
+            .catch((err: Error) => {
+              if (!isMemoryAccessError(err)) {
+                // writing out zeroes for the block would silently corrupt the output
+                fatalError = fatalError || err;
+                return <IMemoryBuffer[]> null;
+              }
+              // none of the memory in the block could be read
+              firstReadError = firstReadError || err;
+              return <IMemoryBuffer[]> [];
+            })
+            .then((blocks: IMemoryBuffer[]) => {
+              --numBlocksInFlight;
+              if (!fatalError) {
+                blocksRead.set(index, blocks);
+              }
+              writeBlocks();
+            });
+          }
+        });
+      };
+
+      outStream.on('error', onStreamError);
+      writeBlocks();
+    });
+  }
+}
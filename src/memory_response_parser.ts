@@ -0,0 +1,63 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+import { RecordType } from './mi_output';
+
+// matches the start of a response to -data-read-memory-bytes
+const responsePrefix = /^\d*\^done,memory=\[/;
+// matches a single memory block in a response to -data-read-memory-bytes, followed by either
+// the separator or the end of the list
+const blockPattern =
+  /\{begin="(0x[0-9a-f]+)",offset="(0x[0-9a-f]+)",end="(0x[0-9a-f]+)",contents="([0-9a-f]*)"\}([,\]])/y;
+
+/** A memory block with its contents decoded by [[parseMemoryBytesResponse]]. */
+export interface IRawMemoryBuffer {
+  begin: string;
+  /** Offset of the block (hex literal) as reported by the debugger. */
+  offset: string;
+  end: string;
+  contents: Buffer;
+}
+
+/**
+ * Parses a response to the -data-read-memory-bytes MI command without going through the
+ * MI Output parser.
+ *
+ * The contents of a block can span megabytes of hex digits, which the MI Output parser would
+ * process one character at a time, before the consumer decodes the resulting string yet again.
+ * This function decodes the contents straight from the line instead.
+ *
+ * @returns The output record in the same form as the MI Output parser would produce it (except
+ *          that the contents of each block are decoded into a `Buffer`), or `undefined` if the
+ *          line isn't a successful response to -data-read-memory-bytes in the expected format, in
+ *          which case the line should be handed to the MI Output parser.
+ */
+export function parseMemoryBytesResponse(line: string): { recordType: RecordType; data: any } {
+  const prefix = responsePrefix.exec(line);
+  if (!prefix) {
+    return undefined;
+  }
+  const memory: IRawMemoryBuffer[] = [];
+  let lastIndex = prefix[0].length;
+  if (line.substr(lastIndex) === ']') {
+    return { recordType: RecordType.Done, data: { memory } };
+  }
+  let isListEnd = false;
+  while (!isListEnd) {
+    blockPattern.lastIndex = lastIndex;
+    const match = blockPattern.exec(line);
+    if (!match || ((match[4].length % 2) !== 0)) {
+      return undefined;
+    }
+    memory.push({
+      begin: match[1],
+      offset: match[2],
+      end: match[3],
+      contents: Buffer.from(match[4], 'hex')
+    });
+    lastIndex = blockPattern.lastIndex;
+    isListEnd = (match[5] === ']');
+  }
+  // the list should be the last thing in the line
+  return (lastIndex === line.length) ? { recordType: RecordType.Done, data: { memory } } : undefined;
+}
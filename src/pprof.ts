@@ -0,0 +1,205 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+import * as zlib from 'zlib';
+
+/** Sample type or period type of a [[IPprofProfile]], e.g. `{ type: 'samples', unit: 'count' }`. */
+export interface IPprofValueType {
+  type: string;
+  unit: string;
+}
+
+export interface IPprofSample {
+  /** Identifiers of the locations in the sampled stack, starting with the innermost one. */
+  locationIds: number[];
+  /** One value per sample type. */
+  values: number[];
+}
+
+export interface IPprofLocation {
+  /** Non-zero identifier of the location. */
+  id: number;
+  /** Code address in hex, e.g. `0x0000000000400710`. */
+  address?: string;
+  /** Identifier of the function the location belongs to. */
+  functionId: number;
+  /** Source line of the location, zero if unknown. */
+  line: number;
+}
+
+export interface IPprofFunction {
+  /** Non-zero identifier of the function. */
+  id: number;
+  name: string;
+  filename?: string;
+}
+
+/**
+ * The subset of the pprof profile format (see
+ * https://github.com/google/pprof/blob/master/proto/profile.proto) needed to represent
+ * sampled call stacks.
+ */
+export interface IPprofProfile {
+  sampleTypes: IPprofValueType[];
+  samples: IPprofSample[];
+  locations: IPprofLocation[];
+  functions: IPprofFunction[];
+  /** When the profile was collected, in milliseconds since the Unix epoch. */
+  timeMs: number;
+  /** How long it took to collect the profile, in milliseconds. */
+  durationMs: number;
+  periodType: IPprofValueType;
+  /** Nominal time between samples, in units of the period type. */
+  period: number;
+}
+
+// wire types
+const VARINT = 0;
+const LENGTH_DELIMITED = 2;
+
+/** Writes protocol buffer fields into a byte array. */
+class ProtobufWriter {
+  bytes: number[] = [];
+
+  /** Writes an unsigned integer of up to 53 bits. */
+  writeVarint(value: number): void {
+    let n = Math.floor(value);
+    while (n >= 0x80) {
+      this.bytes.push((n % 0x80) + 0x80);
+      n = Math.floor(n / 0x80);
+    }
+    this.bytes.push(n);
+  }
+
+  /**
+   * Writes an unsigned integer of arbitrary size given as a string of digits (in base 10 or 16),
+   * numbers such as 64-bit addresses can't be represented exactly by a JavaScript number.
+   */
+  writeVarintDigits(digits: string, radix: number): void {
+    let remaining = digits.split('').map((digit: string) => parseInt(digit, radix));
+    do {
+      // long division by 128
+      const quotient: number[] = [];
+      let remainder = 0;
+      remaining.forEach((digit: number) => {
+        const n = (remainder * radix) + digit;
+        const q = Math.floor(n / 0x80);
+        remainder = n % 0x80;
+        if ((quotient.length > 0) || (q > 0)) {
+          quotient.push(q);
+        }
+      });
+      remaining = quotient;
+      this.bytes.push((remaining.length > 0) ? remainder + 0x80 : remainder);
+    } while (remaining.length > 0);
+  }
+
+  writeTag(field: number, wireType: number): void {
+    this.writeVarint((field * 8) + wireType);
+  }
+
+  writeUint64Field(field: number, value: number): void {
+    if (value) {
+      this.writeTag(field, VARINT);
+      this.writeVarint(value);
+    }
+  }
+
+  writeBytesField(field: number, bytes: number[] | Buffer): void {
+    this.writeTag(field, LENGTH_DELIMITED);
+    this.writeVarint(bytes.length);
+    for (let i = 0; i < bytes.length; ++i) {
+      this.bytes.push(bytes[i]);
+    }
+  }
+
+  writeStringField(field: number, value: string): void {
+    this.writeBytesField(field, Buffer.from(value, 'utf8'));
+  }
+
+  writeMessageField(field: number, write: (writer: ProtobufWriter) => void): void {
+    const writer = new ProtobufWriter();
+    write(writer);
+    this.writeBytesField(field, writer.bytes);
+  }
+
+  writePackedField(field: number, values: number[]): void {
+    if (values.length > 0) {
+      const writer = new ProtobufWriter();
+      values.forEach((value: number) => writer.writeVarint(value));
+      this.writeBytesField(field, writer.bytes);
+    }
+  }
+}
+
+/**
+ * Encodes a profile in the gzipped protocol buffer format read by `pprof` (and other tools that
+ * can display flame graphs such as speedscope).
+ */
+export function encodePprofProfile(profile: IPprofProfile): Buffer {
+  // all strings are stored in a table (whose first entry must be the empty string), and referred
+  // to by index
+  const strings: string[] = [''];
+  const stringIndices = new Map<string, number>([['', 0]]);
+  const getStringIndex = (value: string): number => {
+    if (value === undefined) {
+      return 0;
+    }
+    let index = stringIndices.get(value);
+    if (index === undefined) {
+      index = strings.length;
+      strings.push(value);
+      stringIndices.set(value, index);
+    }
+    return index;
+  };
+  const writeValueType = (valueType: IPprofValueType) => (writer: ProtobufWriter) => {
+    writer.writeUint64Field(1, getStringIndex(valueType.type));
+    writer.writeUint64Field(2, getStringIndex(valueType.unit));
+  };
+
+  const writer = new ProtobufWriter();
+  profile.sampleTypes.forEach((sampleType: IPprofValueType) => {
+    writer.writeMessageField(1, writeValueType(sampleType));
+  });
+  profile.samples.forEach((sample: IPprofSample) => {
+    writer.writeMessageField(2, (sampleWriter: ProtobufWriter) => {
+      sampleWriter.writePackedField(1, sample.locationIds);
+      sampleWriter.writePackedField(2, sample.values);
+    });
+  });
+  profile.locations.forEach((location: IPprofLocation) => {
+    writer.writeMessageField(4, (locationWriter: ProtobufWriter) => {
+      locationWriter.writeUint64Field(1, location.id);
+      const address = location.address ? location.address.replace(/^0x0*/i, '') : '';
+      if (address) {
+        locationWriter.writeTag(3, VARINT);
+        locationWriter.writeVarintDigits(address, 16);
+      }
+      locationWriter.writeMessageField(4, (lineWriter: ProtobufWriter) => {
+        lineWriter.writeUint64Field(1, location.functionId);
+        lineWriter.writeUint64Field(2, location.line);
+      });
+    });
+  });
+  profile.functions.forEach((func: IPprofFunction) => {
+    writer.writeMessageField(5, (functionWriter: ProtobufWriter) => {
+      functionWriter.writeUint64Field(1, func.id);
+      functionWriter.writeUint64Field(2, getStringIndex(func.name));
+      functionWriter.writeUint64Field(3, getStringIndex(func.name));
+      functionWriter.writeUint64Field(4, getStringIndex(func.filename));
+    });
+  });
+  // the string table must be written after everything that may add strings to it
+  const periodTypeWriter = new ProtobufWriter();
+  writeValueType(profile.periodType)(periodTypeWriter);
+  strings.forEach((value: string) => writer.writeStringField(6, value));
+  // the time is in nanoseconds, which exceeds the precision of a number
+  writer.writeTag(9, VARINT);
+  writer.writeVarintDigits(Math.floor(profile.timeMs).toString() + '000000', 10);
+  writer.writeUint64Field(10, Math.round(profile.durationMs * 1e6));
+  writer.writeBytesField(11, periodTypeWriter.bytes);
+  writer.writeUint64Field(12, profile.period);
+
+  return zlib.gzipSync(Buffer.from(writer.bytes));
+}
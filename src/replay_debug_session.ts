@@ -0,0 +1,61 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+import DebugSession from './debug_session';
+import { ITranscriptEntry, TranscriptDirection, TranscriptPlayer } from './transcript';
+
+/**
+ * A debug session that plays back a transcript recorded by [[DebugSession.startRecording]]
+ * instead of communicating with a debugger.
+ *
+ * The session can be driven through the regular [[DebugSession]] API by issuing the same
+ * commands in the same order as in the recording, or [[replay]] can be used to simply re-issue
+ * all the recorded commands. Either way the recorded debugger output goes through the same
+ * parsing and event dispatch code as it would in a live session, so this can be used to
+ * deterministically benchmark that code or reproduce issues without access to the debugger or
+ * the target.
+ */
+export default class ReplayDebugSession extends DebugSession {
+  private transcript: ITranscriptEntry[];
+
+  /**
+   * @param transcript Entries of the transcript to play back, see [[loadTranscript]].
+   * @param options.realTime If `true` the output of the debugger will be played back with the
+   *                         same delays that were observed during the recording, otherwise the
+   *                         output will be played back as fast as possible. *Default*: `false`.
+   */
+  constructor(transcript: ITranscriptEntry[], options?: { realTime?: boolean }) {
+    const player = new TranscriptPlayer(transcript, options);
+    super(player.debuggerOutput, player.debuggerInput);
+    this.transcript = transcript;
+  }
+
+  /**
+   * Re-issues all the commands in the transcript.
+   *
+   * The commands are pipelined, so (unless the session is playing back in real time) the time it
+   * takes for the returned promise to be resolved is dominated by the time it takes to process
+   * the recorded debugger output.
+   *
+   * @returns A promise that will be resolved once responses to all the commands have been
+   *          processed. Commands that failed during the recording will fail during playback too,
+   *          but that will not cause the returned promise to be rejected.
+   */
+  replay(): Promise<void> {
+    const commands = this.transcript
+      .filter((entry: ITranscriptEntry) => entry.direction === TranscriptDirection.ToDebugger)
+      // the session will end up re-issuing gdb-exit itself when it ends
+      .filter((entry: ITranscriptEntry) => !/^\d*-gdb-exit/.test(entry.text));
+
+    return this.pipelineCommands(() => Promise.all(commands.map((entry: ITranscriptEntry) => {
+      const match = /^(\d*)-(.*)$/.exec(entry.text);
+      if (!match) {
+        return Promise.resolve();
+      }
+      return this.executeCommand(match[2], match[1] || null).catch((err: Error) => {
+        // the failure is expected if the command failed during the recording
+      });
+    })))
+    .then(() => {});
+  }
+}
@@ -0,0 +1,427 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+import DebugSession from './debug_session';
+import * as Events from './events';
+import { IStackFrameInfo, IThreadStackInfo, TargetStopReason } from './types';
+import { encodePprofProfile, IPprofLocation, IPprofFunction, IPprofSample } from './pprof';
+
+/** Options that can be passed to the [[SamplingProfiler]] constructor. */
+export interface ISamplingProfilerOptions {
+  /** Number of samples to take per second. *Default*: `10`. */
+  rate?: number;
+  /**
+   * Maximum fraction of time the target may spend paused while samples are taken, e.g. `0.1`
+   * means that the target should be running at least 90% of the time. If taking a sample takes
+   * longer than the rate allows for the sampling rate is reduced accordingly. *Default*: `0.1`.
+   */
+  maxOverhead?: number;
+  /** Maximum number of frames to sample per thread. *Default*: all of them. */
+  maxDepth?: number;
+  /** Identifier of the thread group to sample, defaults to the currently selected inferior. */
+  threadGroup?: string;
+}
+
+/** A frame of a sampled stack. */
+export interface IProfileFrame {
+  /** Function name, or the code address if the function is unknown. */
+  name: string;
+  address: string;
+  filename?: string;
+  line?: number;
+}
+
+/** A distinct stack that was sampled one or more times. */
+export interface IProfileStack {
+  /** Frames of the stack, starting with the innermost frame. */
+  frames: IProfileFrame[];
+  /** Number of times the stack was sampled (across all threads). */
+  count: number;
+  /**
+   * Sum of the time represented by each of the samples of the stack, in milliseconds. Each sample
+   * represents the time elapsed since the previous sample, which is longer than the nominal
+   * sampling interval if the sampling rate was reduced to limit the overhead.
+   */
+  wallMs: number;
+}
+
+/** A node in the call tree built by [[Profile.getCallTree]]. */
+export interface ICallTreeNode {
+  /** Function name. */
+  name: string;
+  /** Number of samples in which this function was the innermost frame. */
+  selfCount: number;
+  /** Number of samples in which this function (or anything it called) was on the stack. */
+  totalCount: number;
+  children: ICallTreeNode[];
+}
+
+/** The results collected by a [[SamplingProfiler]]. */
+export class Profile {
+  /** Number of times the target was sampled. */
+  sampleCount: number = 0;
+  /** How long each sample kept the target paused, in milliseconds. */
+  pauseTimes: number[] = [];
+  /** When profiling started, in milliseconds since the Unix epoch. */
+  startTime: number = Date.now();
+  /** How long profiling lasted, in milliseconds. */
+  durationMs: number = 0;
+  /** Nominal time between samples (before any rate adaptation), in milliseconds. */
+  intervalMs: number;
+  // distinct stacks keyed by the addresses of their frames
+  private stacks = new Map<string, IProfileStack>();
+
+  constructor(intervalMs: number) {
+    this.intervalMs = intervalMs;
+  }
+
+  /** Average time the target was paused per sample, in milliseconds. */
+  get meanPauseMs(): number {
+    return (this.pauseTimes.length > 0) ?
+      this.pauseTimes.reduce((sum: number, time: number) => sum + time, 0) / this.pauseTimes.length :
+      0;
+  }
+
+  /** Longest time the target was paused by a sample, in milliseconds. */
+  get maxPauseMs(): number {
+    return this.pauseTimes.reduce((max: number, time: number) => Math.max(max, time), 0);
+  }
+
+  /** Distinct stacks sampled so far. */
+  getStacks(): IProfileStack[] {
+    const stacks: IProfileStack[] = [];
+    this.stacks.forEach((stack: IProfileStack) => stacks.push(stack));
+    return stacks;
+  }
+
+  /**
+   * @internal Records a single sample of all the threads.
+   *
+   * @param pauseMs How long the sample kept the target paused.
+   * @param wallMs Time elapsed since the previous sample, in milliseconds.
+   */
+  addSample(threadStacks: IThreadStackInfo[], pauseMs: number, wallMs: number): void {
+    ++this.sampleCount;
+    this.pauseTimes.push(pauseMs);
+    threadStacks.forEach((threadStack: IThreadStackInfo) => {
+      if (threadStack.error || (threadStack.frames.length === 0)) {
+        return;
+      }
+      const key = threadStack.frames.map((frame: IStackFrameInfo) => frame.address).join(',');
+      const stack = this.stacks.get(key);
+      if (stack) {
+        ++stack.count;
+        stack.wallMs += wallMs;
+      } else {
+        this.stacks.set(key, {
+          frames: threadStack.frames.map((frame: IStackFrameInfo): IProfileFrame => ({
+            name: frame.func || (frame.from ? `${frame.address} in ${frame.from}` : frame.address),
+            address: frame.address,
+            filename: frame.fullname || frame.filename,
+            line: frame.line
+          })),
+          count: 1,
+          wallMs
+        });
+      }
+    });
+  }
+
+  /**
+   * Aggregates the sampled stacks into a call tree, the root of the tree is a synthetic node
+   * that's the parent of the outermost frames of all the stacks.
+   */
+  getCallTree(): ICallTreeNode {
+    const root: ICallTreeNode = { name: '(root)', selfCount: 0, totalCount: 0, children: [] };
+    // children of each node keyed by function name
+    const childMaps = new Map<ICallTreeNode, Map<string, ICallTreeNode>>();
+    this.stacks.forEach((stack: IProfileStack) => {
+      let node = root;
+      node.totalCount += stack.count;
+      for (let i = stack.frames.length - 1; i >= 0; --i) {
+        const name = stack.frames[i].name;
+        let children = childMaps.get(node);
+        if (!children) {
+          children = new Map<string, ICallTreeNode>();
+          childMaps.set(node, children);
+        }
+        let child = children.get(name);
+        if (!child) {
+          child = { name, selfCount: 0, totalCount: 0, children: [] };
+          children.set(name, child);
+          node.children.push(child);
+        }
+        child.totalCount += stack.count;
+        node = child;
+      }
+      node.selfCount += stack.count;
+    });
+    return root;
+  }
+
+  /**
+   * Converts the sampled stacks to the folded stacks format used by `flamegraph.pl` (and other
+   * flame graph tools), each line contains the function names of a stack (starting with the
+   * outermost frame) separated by semicolons, followed by the number of times it was sampled.
+   */
+  toFoldedStacks(): string {
+    const counts = new Map<string, number>();
+    this.stacks.forEach((stack: IProfileStack) => {
+      const line = stack.frames.map((frame: IProfileFrame) => frame.name).reverse().join(';');
+      counts.set(line, (counts.get(line) || 0) + stack.count);
+    });
+    let folded = '';
+    counts.forEach((count: number, line: string) => {
+      folded += `${line} ${count}\n`;
+    });
+    return folded;
+  }
+
+  /** Encodes the sampled stacks in the gzipped protocol buffer format read by `pprof`. */
+  toPprof(): Buffer {
+    const locations: IPprofLocation[] = [];
+    const locationIds = new Map<string, number>();
+    const functions: IPprofFunction[] = [];
+    const functionIds = new Map<string, number>();
+    const samples: IPprofSample[] = [];
+
+    this.stacks.forEach((stack: IProfileStack) => {
+      samples.push({
+        locationIds: stack.frames.map((frame: IProfileFrame) => {
+          let locationId = locationIds.get(frame.address);
+          if (locationId === undefined) {
+            const functionKey = `${frame.name}\n${frame.filename || ''}`;
+            let functionId = functionIds.get(functionKey);
+            if (functionId === undefined) {
+              functionId = functions.length + 1;
+              functionIds.set(functionKey, functionId);
+              functions.push({ id: functionId, name: frame.name, filename: frame.filename });
+            }
+            locationId = locations.length + 1;
+            locationIds.set(frame.address, locationId);
+            locations.push({
+              id: locationId, address: frame.address, functionId, line: frame.line || 0
+            });
+          }
+          return locationId;
+        }),
+        values: [stack.count, Math.round(stack.wallMs * 1e6)]
+      });
+    });
+
+    return encodePprofProfile({
+      sampleTypes: [{ type: 'samples', unit: 'count' }, { type: 'wall', unit: 'nanoseconds' }],
+      samples,
+      locations,
+      functions,
+      timeMs: this.startTime,
+      durationMs: this.durationMs,
+      periodType: { type: 'wall', unit: 'nanoseconds' },
+      period: Math.round(this.intervalMs * 1e6)
+    });
+  }
+}
+
+/**
+ * A "poor man's profiler" that periodically interrupts the target, captures the stacks of all
+ * its threads, and resumes it again.
+ *
+ * Every sample pauses the target for at least a couple of round trips to the debugger (and much
+ * longer if there are many threads or the stacks are deep), so the sampling rate is adapted to
+ * keep the fraction of time the target spends paused below the `maxOverhead` option. The pause
+ * time of every sample is recorded in the [[Profile]].
+ *
+ * The debugger must be able to execute commands while the target is running, so asynchronous
+ * execution must be enabled (see [[DebugSession.setAsyncExecution]]) before the target is started.
+ *
+ * Example:
+ * ```
+ * const profiler = new SamplingProfiler(debugSession, { rate: 20 });
+ * profiler.start();
+ * setTimeout(() => {
+ *   profiler.stop().then((profile: Profile) => {
+ *     fs.writeFileSync('profile.folded', profile.toFoldedStacks());
+ *     fs.writeFileSync('profile.pb.gz', profile.toPprof());
+ *   });
+ * }, 10000);
+ * ```
+ */
+export class SamplingProfiler {
+  private intervalMs: number;
+  private maxOverhead: number;
+  private profile: Profile;
+  private profileStart: [number, number];
+  // when the target was last stopped to take a sample, null if a sample was skipped since then
+  private lastSampleTime: [number, number];
+  // exponentially weighted moving average of the pause time of each sample
+  private averagePauseMs: number = 0;
+  private timer: NodeJS.Timer = null;
+  // resolved once the current sample has been taken and the target resumed
+  private sampleTaken: Promise<void> = null;
+  private isSampling: boolean = false;
+  private isTargetRunning: boolean = true;
+  private error: Error = null;
+  private onTargetRunning = () => { this.isTargetRunning = true; };
+  private onTargetStopped = () => { this.isTargetRunning = false; };
+  private onTargetExited = () => { this.isSampling = false; };
+
+  constructor(private debugSession: DebugSession, private options?: ISamplingProfilerOptions) {
+    const rate = (options && options.rate) || 10;
+    this.intervalMs = 1000 / rate;
+    this.maxOverhead = (options && options.maxOverhead) || 0.1;
+  }
+
+  /** `true` while samples are being taken. */
+  get isRunning(): boolean {
+    return this.isSampling;
+  }
+
+  /** The number of samples per second currently being taken (after any rate adaptation). */
+  get currentRate(): number {
+    return 1000 / Math.max(this.intervalMs, this.averagePauseMs / this.maxOverhead);
+  }
+
+  /**
+   * Starts taking samples, the target should be running.
+   *
+   * Note that while the profiler is running the target will be stopped and resumed constantly,
+   * so the session should not be used for anything else until the profiler is stopped.
+   */
+  start(): void {
+    if (this.isSampling) {
+      throw new Error('The profiler is already running.');
+    }
+    this.profile = new Profile(this.intervalMs);
+    this.profileStart = process.hrtime();
+    this.lastSampleTime = this.profileStart;
+    this.averagePauseMs = 0;
+    this.error = null;
+    this.isSampling = true;
+    this.isTargetRunning = true;
+    this.debugSession.on(Events.EVENT_TARGET_RUNNING, this.onTargetRunning);
+    this.debugSession.on(Events.EVENT_TARGET_STOPPED, this.onTargetStopped);
+    this.debugSession.on(Events.EVENT_THREAD_GROUP_EXITED, this.onTargetExited);
+    this.scheduleSample(this.intervalMs);
+  }
+
+  /**
+   * Stops taking samples.
+   *
+   * @returns A promise that will be resolved with the collected samples once the target has
+   *          been resumed after the last sample, or rejected if the profiler stopped early
+   *          because a sample couldn't be taken.
+   */
+  stop(): Promise<Profile> {
+    this.isSampling = false;
+    if (this.timer) {
+      clearTimeout(this.timer);
+      this.timer = null;
+    }
+    return (this.sampleTaken || Promise.resolve())
+    .then(() => {
+      this.debugSession.removeListener(Events.EVENT_TARGET_RUNNING, this.onTargetRunning);
+      this.debugSession.removeListener(Events.EVENT_TARGET_STOPPED, this.onTargetStopped);
+      this.debugSession.removeListener(Events.EVENT_THREAD_GROUP_EXITED, this.onTargetExited);
+      const elapsed = process.hrtime(this.profileStart);
+      this.profile.durationMs = (elapsed[0] * 1e3) + (elapsed[1] / 1e6);
+      if (this.error) {
+        throw this.error;
+      }
+      return this.profile;
+    });
+  }
+
+  private scheduleSample(delayMs: number): void {
+    this.timer = setTimeout(() => {
+      this.timer = null;
+      if (!this.isSampling) {
+        return;
+      }
+      if (!this.isTargetRunning) {
+        // something else stopped the target (e.g. a breakpoint), wait for it to be resumed
+        this.lastSampleTime = null;
+        this.scheduleSample(this.intervalMs);
+        return;
+      }
+      this.sampleTaken = this.takeSample()
+      .then((pauseMs: number) => {
+        this.sampleTaken = null;
+        if (pauseMs === null) {
+          // the target was stopped by something other than the interrupt, and was left stopped
+          this.lastSampleTime = null;
+          if (this.isSampling) {
+            this.scheduleSample(this.intervalMs);
+          }
+          return;
+        }
+        this.averagePauseMs = (this.profile.sampleCount === 1) ?
+          pauseMs : (0.8 * this.averagePauseMs) + (0.2 * pauseMs);
+        if (this.isSampling) {
+          // let the target run long enough to keep the overhead below the limit
+          const minRunningTimeMs = this.averagePauseMs * ((1 / this.maxOverhead) - 1);
+          this.scheduleSample(Math.max(this.intervalMs - pauseMs, minRunningTimeMs));
+        }
+      }, (err: Error) => {
+        this.sampleTaken = null;
+        this.error = err;
+        this.isSampling = false;
+      });
+    }, delayMs);
+  }
+
+  /**
+   * Interrupts the target, captures the stacks of all the threads, and resumes the target.
+   *
+   * If the target stops for some other reason (e.g. a breakpoint is hit) before the interrupt
+   * takes effect no sample is taken, and the target is left stopped.
+   *
+   * @returns A promise that will be resolved with the time the target was paused for, or `null`
+   *          if no sample was taken.
+   */
+  private takeSample(): Promise<number> {
+    const threadGroup = this.options ? this.options.threadGroup : undefined;
+    const pauseStart = process.hrtime();
+    let onStopped: (e: Events.ITargetStoppedEvent) => void;
+    const targetStopped = new Promise<Events.ITargetStoppedEvent>((resolve) => {
+      onStopped = resolve;
+      this.debugSession.once(Events.EVENT_TARGET_STOPPED, onStopped);
+    });
+    const interrupted = this.debugSession.interruptInferior(threadGroup)
+    .catch((err: Error) => {
+      // otherwise the listener would mistake some later stop for the interrupt
+      this.debugSession.removeListener(Events.EVENT_TARGET_STOPPED, onStopped);
+      throw err;
+    });
+    return Promise.all([targetStopped, interrupted])
+    .then(([stopEvent]) => {
+      if (stopEvent.reason !== TargetStopReason.SignalReceived) {
+        return null;
+      }
+      return this.debugSession.getAllThreadStacks({
+        maxDepth: this.options ? this.options.maxDepth : undefined
+      })
+      .then((stacks: IThreadStackInfo[]) => {
+        return this.debugSession.resumeInferior({ threadGroup })
+        .then(() => {
+          const elapsed = process.hrtime(pauseStart);
+          const pauseMs = (elapsed[0] * 1e3) + (elapsed[1] / 1e6);
+          this.profile.addSample(stacks, pauseMs, this.getTimeSinceLastSample(pauseStart));
+          this.lastSampleTime = pauseStart;
+          return pauseMs;
+        });
+      });
+    });
+  }
+
+  /**
+   * Computes the time that a sample taken at the given time represents, in milliseconds. If the
+   * previous sample was skipped the current sampling interval is used instead.
+   */
+  private getTimeSinceLastSample(sampleTime: [number, number]): number {
+    if (!this.lastSampleTime) {
+      return 1000 / this.currentRate;
+    }
+    return ((sampleTime[0] - this.lastSampleTime[0]) * 1e3) +
+      ((sampleTime[1] - this.lastSampleTime[1]) / 1e6);
+  }
+}
@@ -0,0 +1,52 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+import { IProcessSnapshot } from './types';
+
+/**
+ * Serializes a process snapshot to [newline delimited JSON](http://ndjson.org/).
+ *
+ * The first line describes the process as a whole, it's followed by one line per thread, and
+ * finally one line per captured memory region. Each line is a compact JSON object with a `type`
+ * field set to one of `process`, `thread`, or `memory`. Consumers can therefore start processing
+ * threads without having to parse the whole snapshot first, and snapshots from multiple core
+ * dumps can simply be concatenated.
+ *
+ * @param snapshot The snapshot to serialize, as returned by [[DebugSession.getProcessSnapshot]].
+ * @param source Optional identifier of the snapshot source (e.g. the path of the core dump), if
+ *               provided it will be included in the `process` line.
+ * @returns The serialized snapshot, terminated by a newline.
+ */
+export function formatSnapshotAsNDJSON(snapshot: IProcessSnapshot, source?: string): string {
+  const lines: string[] = [
+    JSON.stringify({
+      type: 'process',
+      source,
+      currentThreadId: snapshot.currentThreadId,
+      threadCount: snapshot.threads.length
+    })
+  ];
+  snapshot.threads.forEach((thread) => {
+    lines.push(JSON.stringify({
+      type: 'thread',
+      id: thread.id,
+      targetId: thread.targetId,
+      name: thread.name,
+      frames: thread.frames,
+      registers: thread.registers,
+      errors: thread.errors
+    }));
+  });
+  if (snapshot.memory) {
+    snapshot.memory.forEach((region) => {
+      lines.push(JSON.stringify({
+        type: 'memory',
+        address: region.address,
+        length: region.length,
+        blocks: region.blocks,
+        error: region.error
+      }));
+    });
+  }
+  return lines.join('\n') + '\n';
+}
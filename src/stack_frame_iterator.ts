@@ -0,0 +1,171 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+import DebugSession from './debug_session';
+import { IStackFrameInfo } from './types';
+
+/** Options that can be passed to [[DebugSession.iterateStackFrames]]. */
+export interface IStackFrameIteratorOptions {
+  /**
+   * The thread whose frames should be retrieved, defaults to the currently selected thread if
+   * not specified.
+   */
+  threadId?: number;
+  /** Maximum number of frames to retrieve with each command. *Default*: `100`. */
+  pageSize?: number;
+  /**
+   * *(GDB specific)* Maximum number of frames to iterate over, the debugger won't unwind the
+   * stack past this depth. If not specified all the frames on the stack will be iterated over.
+   */
+  maxDepth?: number;
+  /** *(GDB specific)* If `true` the Python frame filters will not be executed. */
+  noFrameFilters?: boolean;
+}
+
+/**
+ * Iterates over the frames on the stack of a thread one page at a time.
+ *
+ * Retrieving all the frames of a very deep stack (e.g. one resulting from runaway recursion) in
+ * one go produces a single gigantic response that ties up both the debugger and the event loop,
+ * this iterator retrieves a limited number of frames at a time instead, and the consumer can stop
+ * iterating as soon as it has seen enough frames.
+ *
+ * The iterator follows the ES2015 iterator protocol, except that [[next]] returns a promise.
+ *
+ * Example:
+ * ```
+ * const frames = debugSession.iterateStackFrames({ threadId: 1, pageSize: 50 });
+ * frames.forEach((page: IStackFrameInfo[]) => {
+ *   page.forEach(frame => console.log(frame.func));
+ *   return page[page.length - 1].level < 200; // stop after 200 frames
+ * });
+ * ```
+ */
+export class StackFrameIterator {
+  private pageSize: number;
+  // level of the first frame in the next page
+  private nextLevel: number = 0;
+  private depthRetrieved: Promise<number>;
+  private isDone: boolean = false;
+  // pages are retrieved one after another even if next() is called before the last page arrived
+  private lastPageRetrieved: Promise<any> = Promise.resolve();
+
+  constructor(private debugSession: DebugSession, private options?: IStackFrameIteratorOptions) {
+    this.pageSize = (options && options.pageSize) || 100;
+    if (this.pageSize < 1) {
+      throw new Error('pageSize option must be greater than zero.');
+    }
+  }
+
+  /**
+   * Retrieves the number of frames this iterator will iterate over in total (which won't exceed
+   * the `maxDepth` option).
+   */
+  getDepth(): Promise<number> {
+    if (!this.depthRetrieved) {
+      this.depthRetrieved = this.debugSession.getStackDepth({
+        threadId: this.options ? this.options.threadId : undefined,
+        maxDepth: this.options ? this.options.maxDepth : undefined
+      });
+    }
+    return this.depthRetrieved;
+  }
+
+  /**
+   * Retrieves the next page of frames.
+   *
+   * @returns A promise that will be resolved with the next page of frames, or with a result
+   *          whose `done` property is set to `true` once there are no more frames.
+   */
+  next(): Promise<IteratorResult<IStackFrameInfo[]>> {
+    const pageRetrieved = this.lastPageRetrieved.then(() => this.retrieveNextPage());
+    // a failed page shouldn't prevent subsequent pages from being retrieved
+    this.lastPageRetrieved = pageRetrieved.catch(() => {});
+    return pageRetrieved;
+  }
+
+  /** Stops the iteration, any subsequent calls to [[next]] will not retrieve any more frames. */
+  return(): Promise<IteratorResult<IStackFrameInfo[]>> {
+    this.isDone = true;
+    return Promise.resolve({ done: true, value: <IStackFrameInfo[]> undefined });
+  }
+
+  /**
+   * Invokes a callback for every remaining page of frames.
+   *
+   * @param callback Function to invoke for each page, if it returns `false` (or a promise that's
+   *                 resolved with `false`) the iteration stops.
+   * @returns A promise that will be resolved once the iteration is done.
+   */
+  forEach(
+    callback: (frames: IStackFrameInfo[]) => boolean | void | Promise<boolean | void>
+  ): Promise<void> {
+    return this.next()
+    .then((result: IteratorResult<IStackFrameInfo[]>) => {
+      if (result.done) {
+        return;
+      }
+      return Promise.resolve(callback(result.value))
+      .then((shouldContinue: boolean | void) => {
+        if (shouldContinue === false) {
+          return this.return().then(() => {});
+        }
+        return this.forEach(callback);
+      });
+    });
+  }
+
+  private retrieveNextPage(): Promise<IteratorResult<IStackFrameInfo[]>> {
+    if (this.isDone) {
+      return Promise.resolve({ done: true, value: <IStackFrameInfo[]> undefined });
+    }
+    const lowFrame = this.nextLevel;
+    const maxDepth = this.options ? this.options.maxDepth : undefined;
+    let framesRetrieved: Promise<IStackFrameInfo[]>;
+    if (this.depthRetrieved) {
+      framesRetrieved = this.depthRetrieved.then((depth: number) => {
+        if (lowFrame >= depth) {
+          // the debugger would fail the command if asked for frames past the end of the stack
+          return <IStackFrameInfo[]> [];
+        }
+        return this.retrieveFrames(lowFrame, Math.min(lowFrame + this.pageSize, depth) - 1);
+      });
+    } else {
+      // the first page can be retrieved along with the depth of the stack, since the highFrame
+      // passed to the debugger may exceed the depth
+      let highFrame = this.pageSize - 1;
+      if (maxDepth !== undefined) {
+        highFrame = Math.min(highFrame, maxDepth - 1);
+      }
+      framesRetrieved = this.debugSession.pipelineCommands(() => {
+        // if this fails the error will be reported by the next page
+        this.getDepth().catch(() => {});
+        if (highFrame < 0) {
+          return Promise.resolve(<IStackFrameInfo[]> []);
+        }
+        return this.retrieveFrames(0, highFrame);
+      });
+    }
+    return framesRetrieved.then((frames: IStackFrameInfo[]) => {
+      if (frames.length === 0) {
+        this.isDone = true;
+        return { done: true, value: <IStackFrameInfo[]> undefined };
+      }
+      this.nextLevel = frames[frames.length - 1].level + 1;
+      if (frames.length < this.pageSize) {
+        // the end of the stack has been reached
+        this.isDone = true;
+      }
+      return { done: false, value: frames };
+    });
+  }
+
+  private retrieveFrames(lowFrame: number, highFrame: number): Promise<IStackFrameInfo[]> {
+    return this.debugSession.getStackFrames({
+      threadId: this.options ? this.options.threadId : undefined,
+      noFrameFilters: this.options ? this.options.noFrameFilters : undefined,
+      lowFrame,
+      highFrame
+    });
+  }
+}
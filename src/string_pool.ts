@@ -0,0 +1,57 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+/**
+ * Stores a single copy of each distinct string added to it, and assigns each one a numeric
+ * identifier.
+ *
+ * Every response from the debugger is parsed into brand new strings, so a session that holds on
+ * to many frames (e.g. a profiler) ends up with a separate copy of the same function names and
+ * paths for every frame. Interning those strings makes all the frames share one copy, the copies
+ * produced by the parser can then be garbage collected.
+ *
+ * Strings are never removed from the pool, so it should only be used for strings that are likely
+ * to repeat, such as function names and paths.
+ */
+export class StringPool {
+  // identifier of each string in the pool, identifiers start at 1 so 0 can mean "no string"
+  private ids = new Map<string, number>();
+  private strings: string[] = [undefined];
+
+  /** Number of distinct strings in the pool. */
+  get size(): number {
+    return this.ids.size;
+  }
+
+  /**
+   * Adds a string to the pool (if it's not already in it).
+   *
+   * @returns The identifier of the string, or zero if the string is `undefined`.
+   */
+  getId(value: string): number {
+    if (value === undefined) {
+      return 0;
+    }
+    let id = this.ids.get(value);
+    if (id === undefined) {
+      id = this.strings.length;
+      this.strings.push(value);
+      this.ids.set(value, id);
+    }
+    return id;
+  }
+
+  /** Retrieves the string with the given identifier, or `undefined` if the identifier is zero. */
+  getString(id: number): string {
+    return this.strings[id];
+  }
+
+  /**
+   * Adds a string to the pool (if it's not already in it).
+   *
+   * @returns The copy of the string stored in the pool.
+   */
+  intern(value: string): string {
+    return this.strings[this.getId(value)];
+  }
+}
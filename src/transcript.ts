@@ -0,0 +1,260 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+import * as fs from 'fs';
+import * as stream from 'stream';
+
+/** Indicates which way a line in a transcript was travelling. */
+export enum TranscriptDirection {
+  /** The line was sent to the debugger (i.e. it's a command). */
+  ToDebugger,
+  /** The line was received from the debugger (i.e. it's a response or a notification). */
+  FromDebugger
+}
+
+/** A single line of MI text captured by a [[TranscriptRecorder]]. */
+export interface ITranscriptEntry {
+  /** Number of milliseconds elapsed between the start of the recording and this entry. */
+  time: number;
+  direction: TranscriptDirection;
+  /** Raw MI text (without the line terminator). */
+  text: string;
+}
+
+// In a transcript file each entry is stored on a separate line in the following format:
+// <elapsed time in ms> <direction> <raw MI text>
+// The direction is either '>' (sent to the debugger), or '<' (received from the debugger).
+const entryRegExp = /^(\d+(?:\.\d+)?) ([<>]) (.*)$/;
+
+/**
+ * Records the raw MI text exchanged with a debugger to a stream.
+ *
+ * The recorded transcript can be loaded with [[loadTranscript]] and played back with
+ * [[TranscriptPlayer]] or [[ReplayDebugSession]].
+ */
+export class TranscriptRecorder {
+  private startTime: [number, number];
+
+  /**
+   * @param outStream Stream the transcript will be written to.
+   */
+  constructor(private outStream: stream.Writable) {
+    this.startTime = process.hrtime();
+  }
+
+  /**
+   * Creates a recorder that writes to a file.
+   *
+   * @param filename Path of the file the transcript should be written to, if the file already
+   *                 exists it will be overwritten.
+   */
+  static createForFile(filename: string): TranscriptRecorder {
+    return new TranscriptRecorder(fs.createWriteStream(filename, { flags: 'w' }));
+  }
+
+  /** Records a line of text that was sent to the debugger. */
+  recordCommand(text: string): void {
+    this.record('>', text);
+  }
+
+  /** Records a line of text that was received from the debugger. */
+  recordOutput(text: string): void {
+    this.record('<', text);
+  }
+
+  /**
+   * Stops recording.
+   *
+   * @returns A promise that will be resolved once the transcript has been flushed.
+   */
+  end(): Promise<void> {
+    return new Promise<void>((resolve, reject) => {
+      this.outStream.once('error', reject);
+      this.outStream.once('finish', resolve);
+      this.outStream.end();
+    });
+  }
+
+  private record(direction: string, text: string): void {
+    const elapsed = process.hrtime(this.startTime);
+    const time = (elapsed[0] * 1e3) + (elapsed[1] / 1e6);
+    this.outStream.write(`${time.toFixed(3)} ${direction} ${text}\n`);
+  }
+}
+
+/**
+ * Parses the text of a transcript written by a [[TranscriptRecorder]].
+ *
+ * @param text The contents of a transcript file.
+ * @returns The list of entries in the transcript.
+ */
+export function parseTranscript(text: string): ITranscriptEntry[] {
+  const entries: ITranscriptEntry[] = [];
+  text.split('\n').forEach((line: string, lineIndex: number) => {
+    if (line === '') {
+      return;
+    }
+    const match = entryRegExp.exec(line);
+    if (!match) {
+      throw new Error(`Malformed transcript entry on line ${lineIndex + 1}: ${line}`);
+    }
+    entries.push({
+      time: parseFloat(match[1]),
+      direction: (match[2] === '>') ? TranscriptDirection.ToDebugger : TranscriptDirection.FromDebugger,
+      text: match[3]
+    });
+  });
+  return entries;
+}
+
+/**
+ * Loads a transcript file written by a [[TranscriptRecorder]].
+ *
+ * @param filename Path of the transcript file.
+ * @returns A promise that will be resolved with the list of entries in the transcript.
+ */
+export function loadTranscript(filename: string): Promise<ITranscriptEntry[]> {
+  return new Promise<ITranscriptEntry[]>((resolve, reject) => {
+    fs.readFile(filename, 'utf8', (err: Error, text: string) => {
+      if (err) {
+        reject(err);
+      } else {
+        try {
+          resolve(parseTranscript(text));
+        } catch (err) {
+          reject(err);
+        }
+      }
+    });
+  });
+}
+
+/**
+ * Stands in for a debugger process by playing back a previously recorded transcript.
+ *
+ * The player provides a pair of streams that can be passed to the [[DebugSession]] constructor
+ * in place of the debugger's stdout and stdin. Every line of debugger output in the transcript
+ * is played back once the session has sent the command it depends on: a response is played back
+ * after the command it's responding to has been sent, while any other output is played back once
+ * the session has sent the last command that preceded the output in the recording (or the
+ * command whose response preceded it, whichever comes first). So the session sees the same
+ * responses and notifications in the same order as during the recording, without a debugger
+ * running, regardless of whether the commands were pipelined during the recording.
+ *
+ * Note that the commands sent by the session are not checked against the transcript, the player
+ * simply assumes they're issued in the same order as in the recording. If the session sends more
+ * commands than there are in the transcript they will fail (except for `gdb-exit`, which will
+ * succeed so that the session can be ended cleanly).
+ */
+export class TranscriptPlayer {
+  /** Debugger output, pass this to the [[DebugSession]] constructor as the input stream. */
+  debuggerOutput: stream.Readable;
+  /** Debugger input, pass this to the [[DebugSession]] constructor as the output stream. */
+  debuggerInput: stream.Writable;
+
+  // recorded debugger output, along with the index of the command each line depends on
+  // (-1 if the line doesn't depend on any command)
+  private outputLines: Array<{ text: string; time: number; commandIndex: number }> = [];
+  // the time at which each command was recorded
+  private commandTimes: number[] = [];
+  // the (wall clock) time at which each command was received during playback
+  private commandReceivedTimes: number[] = [];
+  // index of the next line in outputLines to play back
+  private nextLine: number = 0;
+  // lines waiting to be played back in real time (in order)
+  private pendingLines: Array<{ text: string; due: number }> = [];
+  private lastDue: number = 0;
+  private timer: NodeJS.Timer = null;
+  private partialCommand: string = '';
+
+  /**
+   * @param transcript Entries of the transcript to play back.
+   * @param options.realTime If `true` the output of the debugger will be played back with the
+   *                         same delays that were observed during the recording, otherwise the
+   *                         output will be played back as fast as possible. *Default*: `false`.
+   */
+  constructor(transcript: ITranscriptEntry[], private options?: { realTime?: boolean }) {
+    let numResults = 0;
+    transcript.forEach((entry: ITranscriptEntry) => {
+      if (entry.direction === TranscriptDirection.ToDebugger) {
+        this.commandTimes.push(entry.time);
+      } else if (/^\d*\^/.test(entry.text)) {
+        // a result record is a response to the oldest command that hasn't been responded to yet
+        this.outputLines.push({ text: entry.text, time: entry.time, commandIndex: numResults++ });
+      } else {
+        this.outputLines.push({
+          text: entry.text,
+          time: entry.time,
+          commandIndex: Math.min(this.commandTimes.length - 1, numResults)
+        });
+      }
+    });
+    this.debuggerOutput = new stream.Readable({ read: () => {} });
+    this.debuggerInput = new stream.Writable({
+      write: (chunk: Buffer | string, encoding: string, callback: Function) => {
+        this.onInput(chunk.toString());
+        callback();
+      }
+    });
+    // play back the output that preceded the first command
+    this.playAvailableLines();
+  }
+
+  private onInput(text: string): void {
+    const lines = (this.partialCommand + text).split('\n');
+    // the last element is either empty or a partially written command
+    this.partialCommand = lines.pop();
+    lines.forEach((line: string) => {
+      if (this.commandReceivedTimes.length < this.commandTimes.length) {
+        this.commandReceivedTimes.push(Date.now());
+        this.playAvailableLines();
+      } else if (/^\d*-gdb-exit/.test(line)) {
+        this.playLine('^exit', Date.now());
+      } else {
+        this.playLine('^error,msg="End of transcript."', Date.now());
+      }
+    });
+  }
+
+  /** Plays back all the lines whose commands have been received. */
+  private playAvailableLines(): void {
+    while ((this.nextLine < this.outputLines.length) &&
+           (this.outputLines[this.nextLine].commandIndex < this.commandReceivedTimes.length)) {
+      const line = this.outputLines[this.nextLine++];
+      if (line.commandIndex < 0) {
+        this.playLine(line.text, Date.now() + line.time);
+      } else {
+        const delay = line.time - this.commandTimes[line.commandIndex];
+        this.playLine(line.text, this.commandReceivedTimes[line.commandIndex] + delay);
+      }
+    }
+  }
+
+  /**
+   * @param due The time at which the line should be played back when playing back in real time.
+   */
+  private playLine(text: string, due: number): void {
+    if (!(this.options && this.options.realTime)) {
+      this.debuggerOutput.push(text + '\n');
+      return;
+    }
+    // lines must be played back in order, so a line can't be due before the preceding line
+    this.lastDue = Math.max(due, this.lastDue);
+    this.pendingLines.push({ text, due: this.lastDue });
+    this.schedulePendingLines();
+  }
+
+  private schedulePendingLines(): void {
+    if (this.timer || (this.pendingLines.length === 0)) {
+      return;
+    }
+    this.timer = setTimeout(() => {
+      this.timer = null;
+      const now = Date.now();
+      while ((this.pendingLines.length > 0) && (this.pendingLines[0].due <= now)) {
+        this.debuggerOutput.push(this.pendingLines.shift().text + '\n');
+      }
+      this.schedulePendingLines();
+    }, Math.max(0, this.pendingLines[0].due - Date.now()));
+  }
+}
@@ -1,6 +1,8 @@
 ﻿// Copyright (c) 2015 Vadim Macagon
 // MIT License, see LICENSE file for full terms.
 
+import { Address } from './address';
+
 export enum TargetStopReason {
   /** A breakpoint was hit. */
   BreakpointHit,
@@ -27,6 +29,8 @@ export interface IFrameInfoBase {
   func?: string;
   /** Code address of the frame. */
   address: string;
+  /** Parsed [[address]], only set if [[DebugSession.numericAddresses]] is enabled. */
+  numericAddress?: Address;
   /** Name of the source file corresponding to the frame's code address. */
   filename?: string;
   /** Full path of the source file corresponding to the frame's code address. */
@@ -67,6 +71,8 @@ export interface IBreakpointLocationInfo {
   isEnabled?: boolean;
   /** Address of the breakpoint location as a hexadecimal literal. */
   address?: string;
+  /** Parsed [[address]], only set if [[DebugSession.numericAddresses]] is enabled. */
+  numericAddress?: Address;
   /**
    * The name of the function within which the breakpoint location is set.
    * If function name is not known then this field will be undefined.
@@ -215,6 +221,13 @@ export interface IWatchChildInfo extends IWatchInfo {
   isFrozen: boolean;
 }
 
+/** A range of children of a watch retrieved by [[DebugSession.getWatchChildRange]]. */
+export interface IWatchChildRange {
+  children: IWatchChildInfo[];
+  /** `true` iff the watch has more children beyond the end of the range. */
+  hasMoreChildren: boolean;
+}
+
 /** Contains information about the changes in the state of a watch. */
 export interface IWatchUpdateInfo {
   /** Unique identifier of the watch whose state changed. */
@@ -259,7 +272,7 @@ export interface IWatchUpdateInfo {
     * If `isDynamic` is `true` and new children were added within the update range this will
     * be a list of those new children. Otherwise this field is undefined.
     */
-  newChildren?: string;
+  newChildren?: IWatchChildInfo[];
 }
 
 /** Output format specifiers for watch values. */
@@ -299,12 +312,36 @@ export interface IMemoryBlock {
   offset: string;
   /** Contents of the memory block in hexadecimal. */
   contents: string;
+  /** Parsed [[begin]], only set if [[DebugSession.numericAddresses]] is enabled. */
+  numericBegin?: Address;
+  /** Parsed [[end]], only set if [[DebugSession.numericAddresses]] is enabled. */
+  numericEnd?: Address;
+  /** Parsed [[offset]], only set if [[DebugSession.numericAddresses]] is enabled. */
+  numericOffset?: number;
+}
+
+/** Contains the contents of a block of memory read by [[DebugSession.readMemoryBuffer]]. */
+export interface IMemoryBuffer {
+  /** Start address of the memory block (hex literal). */
+  begin: string;
+  /** End address of the memory block (hex literal). */
+  end: string;
+  /** Offset of the memory block (in bytes) from the first address that was to be read. */
+  offset: number;
+  /** Contents of the memory block. */
+  contents: Buffer;
+  /** Parsed [[begin]], only set if [[DebugSession.numericAddresses]] is enabled. */
+  numericBegin?: Address;
+  /** Parsed [[end]], only set if [[DebugSession.numericAddresses]] is enabled. */
+  numericEnd?: Address;
 }
 
 /** Contains information about an ASM instruction. */
 export interface IAsmInstruction {
   /** Address at which this instruction was disassembled. */
   address: string;
+  /** Parsed [[address]], only set if [[DebugSession.numericAddresses]] is enabled. */
+  numericAddress?: Address;
   /** Name of the function this instruction came from. */
   func: string;
   /** Offset of this instruction from the start of `func` (as a decimal). */
@@ -384,3 +421,192 @@ export interface IMultiThreadInfo {
   /** Thread currently selected in the debugger. */
   current: IThreadInfo;
 }
+
+/** Frame-specific information along with the arguments and local variables of the frame. */
+export interface IStackFrameDetailedInfo extends IStackFrameInfo {
+  /** Arguments of the function corresponding to the frame. */
+  args?: IVariableInfo[];
+  /** Local variables of the function corresponding to the frame. */
+  locals?: IVariableInfo[];
+}
+
+/** Contains the stack of a single thread retrieved by [[DebugSession.getAllThreadStacks]]. */
+export interface IThreadStackInfo {
+  /** Identifier used by the debugger to identify the thread. */
+  id: number;
+  /** Identifier used by the target to identify the thread. */
+  targetId: string;
+  /** Thread name, may be `undefined`. */
+  name?: string;
+  /**
+   * Stack frames of the thread, starting with the innermost frame. The `args` of each frame
+   * will only be set if they were requested.
+   */
+  frames: IStackFrameDetailedInfo[];
+  /**
+   * If the stack of the thread couldn't be retrieved this will contain the error message
+   * reported by the debugger, otherwise this field will be `undefined`.
+   */
+  error?: string;
+}
+
+/** Contains the state of a single thread captured by [[DebugSession.getProcessSnapshot]]. */
+export interface IThreadSnapshot {
+  /** Identifier used by the debugger to identify the thread. */
+  id: number;
+  /** Identifier used by the target to identify the thread. */
+  targetId: string;
+  /** Thread name, may be `undefined`. */
+  name?: string;
+  /** Stack frames of the thread, starting with the innermost frame. */
+  frames: IStackFrameDetailedInfo[];
+  /** Register values of the innermost frame keyed by register name (only if requested). */
+  registers?: { [name: string]: string };
+  /**
+   * If some of the thread state couldn't be retrieved this will contain the error messages
+   * reported by the debugger, otherwise this field will be `undefined`.
+   */
+  errors?: string[];
+}
+
+/** Contains the contents of a memory region captured by [[DebugSession.getProcessSnapshot]]. */
+export interface IMemoryRegionSnapshot {
+  /** Start of the region as it was passed to [[DebugSession.getProcessSnapshot]]. */
+  address: string;
+  /** Length of the region in bytes. */
+  length: number;
+  /** Accessible blocks of memory within the region. */
+  blocks?: IMemoryBlock[];
+  /** Error message reported by the debugger if the region couldn't be read. */
+  error?: string;
+}
+
+/** Contains the state of all the threads in the target captured at a single point in time. */
+export interface IProcessSnapshot {
+  /** Identifier of the thread that was selected in the debugger when the snapshot was taken. */
+  currentThreadId: number;
+  threads: IThreadSnapshot[];
+  memory?: IMemoryRegionSnapshot[];
+}
+
+/** A breakpoint created via [[DebugSession.addBreakpoint]], as recorded by [[DebugSession.exportState]]. */
+export interface IBreakpointState {
+  /** The location that was passed to [[DebugSession.addBreakpoint]]. */
+  location: string;
+  /** Current options of the breakpoint, in the form accepted by [[DebugSession.addBreakpoint]]. */
+  options: {
+    isHardware?: boolean;
+    isPending?: boolean;
+    isDisabled?: boolean;
+    isTracepoint?: boolean;
+    condition?: string;
+    ignoreCount?: number;
+    threadId?: number;
+  };
+}
+
+/** Specifies a watch to be created by [[DebugSession.addWatches]]. */
+export interface IWatchSpec {
+  /** The expression to watch. */
+  expression: string;
+  /** Options to create the watch with, same as the ones accepted by [[DebugSession.addWatch]]. */
+  options?: {
+    id?: string;
+    threadId?: number;
+    threadGroup?: string;
+    frameLevel?: number;
+    frameAddress?: string;
+    isFloating?: boolean;
+  };
+}
+
+/** Outcome of creating a single watch via [[DebugSession.addWatches]]. */
+export interface IWatchCreationResult {
+  /** The watch that was created, `null` if the watch couldn't be created. */
+  watch: IWatchInfo;
+  /** The reason the watch couldn't be created, `null` if the watch was created. */
+  error: Error;
+}
+
+/** A watch created via [[DebugSession.addWatch]], as recorded by [[DebugSession.exportState]]. */
+export interface IWatchState extends IWatchSpec {
+  /** The expression that was passed to [[DebugSession.addWatch]]. */
+  expression: string;
+  /**
+   * The options that were passed to [[DebugSession.addWatch]], `id` is only present if the
+   * watch identifier wasn't auto-generated by the debugger.
+   */
+  options: {
+    id?: string;
+    threadId?: number;
+    threadGroup?: string;
+    frameLevel?: number;
+    frameAddress?: string;
+    isFloating?: boolean;
+  };
+}
+
+/**
+ * Breakpoints and watches created by a debug session, can be serialized with `JSON.stringify()`
+ * and passed to [[DebugSession.importState]] to recreate them in another debug session.
+ */
+export interface ISessionState {
+  breakpoints: IBreakpointState[];
+  watches: IWatchState[];
+}
+
+/** Outcome of [[DebugSession.importState]]. */
+export interface ISessionStateImportResult {
+  /**
+   * Breakpoints that were created, in the same order as in the imported state,
+   * `null` if the corresponding breakpoint couldn't be created.
+   */
+  breakpoints: IBreakpointInfo[];
+  /**
+   * Watches that were created, in the same order as in the imported state,
+   * `null` if the corresponding watch couldn't be created.
+   */
+  watches: IWatchInfo[];
+  /** Breakpoints that couldn't be created, along with the reason why. */
+  failedBreakpoints: { state: IBreakpointState; error: Error }[];
+  /** Watches that couldn't be created, along with the reason why. */
+  failedWatches: { state: IWatchState; error: Error }[];
+}
+
+/** Outcome of [[DebugSession.attachToProcess]]. */
+export interface IAttachInfo {
+  /** Identifier of the process the debugger attached to. */
+  pid: number;
+  /** Identifier of the thread group the debugger associated with the process. */
+  threadGroup: string;
+  /** Time (in milliseconds) it took the debugger to attach to the process. */
+  attachTime: number;
+}
+
+/** Outcome of [[DebugSession.detach]]. */
+export interface IDetachInfo {
+  /**
+   * Total time (in milliseconds) the process spent stopped while the debugger was attached to it,
+   * `undefined` if the debugger wasn't attached via [[DebugSession.attachToProcess]].
+   */
+  stoppedTime: number;
+}
+
+/** An expression to be evaluated via [[DebugSession.evaluateExpressions]]. */
+export interface IExpressionSpec {
+  expression: string;
+  /**
+   * Set to `true` if evaluating the expression can't modify the state of the target (i.e. it
+   * doesn't contain any assignments or function calls), the value of such an expression is
+   * remembered until the target resumes execution. *Default*: `false`.
+   */
+  isSideEffectFree?: boolean;
+}
+
+/** Outcome of evaluating a single expression via [[DebugSession.evaluateExpressions]]. */
+export interface IExpressionResult {
+  /** The value of the expression, `null` if the expression couldn't be evaluated. */
+  value: string;
+  /** The reason the expression couldn't be evaluated, `null` if it was evaluated. */
+  error: Error;
+}
@@ -0,0 +1,168 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+import { WatchFormatSpec } from './types';
+
+/**
+ * Width (in bits) of the integer types whose values can be formatted by [[formatIntegerValue]],
+ * keyed by type name. The width of some types depends on the target platform (e.g. `long` is 32
+ * bits wide on Windows, but 64 bits wide on Linux), such types map to `undefined`, which means
+ * that only their non-negative values can be formatted.
+ */
+const integerTypeWidths = new Map<string, number>([
+  ['char', 8], ['signed char', 8], ['unsigned char', 8],
+  ['short', 16], ['short int', 16], ['signed short', 16], ['signed short int', 16],
+  ['unsigned short', 16], ['unsigned short int', 16], ['short unsigned int', 16],
+  ['int', 32], ['signed', 32], ['signed int', 32], ['unsigned', 32], ['unsigned int', 32],
+  ['long', undefined], ['long int', undefined], ['signed long', undefined],
+  ['signed long int', undefined], ['unsigned long', undefined], ['unsigned long int', undefined],
+  ['long unsigned int', undefined],
+  ['long long', 64], ['long long int', 64], ['signed long long', 64],
+  ['signed long long int', 64], ['unsigned long long', 64], ['unsigned long long int', 64],
+  ['long long unsigned int', 64],
+  ['__int128', 128], ['unsigned __int128', 128], ['__int128_t', 128], ['__uint128_t', 128],
+  ['__int128 unsigned', 128],
+  ['int8_t', 8], ['uint8_t', 8], ['int16_t', 16], ['uint16_t', 16],
+  ['int32_t', 32], ['uint32_t', 32], ['int64_t', 64], ['uint64_t', 64],
+  ['size_t', undefined], ['ssize_t', undefined], ['ptrdiff_t', undefined],
+  ['intptr_t', undefined], ['uintptr_t', undefined]
+]);
+
+// character types are displayed as characters by default (int8_t and uint8_t are typedefs of
+// character types, so the debugger displays them as characters too)
+const characterTypes = new Set<string>([
+  'char', 'signed char', 'unsigned char', 'int8_t', 'uint8_t'
+]);
+
+/** Strips cv-qualifiers and redundant whitespace from a type name. */
+function normalizeTypeName(typeName: string): string {
+  return typeName.replace(/\b(const|volatile)\b/g, ' ').replace(/\s+/g, ' ').trim();
+}
+
+/**
+ * Checks if values of the given type can be formatted by [[formatIntegerValue]].
+ *
+ * @param typeName Type name as reported by the debugger (e.g. `unsigned long long`).
+ */
+export function isFormattableIntegerType(typeName: string): boolean {
+  return (typeName !== undefined) && integerTypeWidths.has(normalizeTypeName(typeName));
+}
+
+/**
+ * Converts a string of decimal digits to an arbitrary precision unsigned integer, represented
+ * as an array of 16-bit limbs (least significant limb first).
+ */
+function parseDecimalDigits(digits: string): number[] {
+  const limbs: number[] = [0];
+  for (let i = 0; i < digits.length; ++i) {
+    let carry = digits.charCodeAt(i) - 48;
+    for (let j = 0; j < limbs.length; ++j) {
+      const n = (limbs[j] * 10) + carry;
+      limbs[j] = n % 0x10000;
+      carry = Math.floor(n / 0x10000);
+    }
+    if (carry) {
+      limbs.push(carry);
+    }
+  }
+  return limbs;
+}
+
+/** Computes the two's complement representation of `-n` in the given number of bits. */
+function negate(limbs: number[], width: number): number[] {
+  const numLimbs = Math.ceil(width / 16);
+  const result: number[] = [];
+  let carry = 1;
+  for (let i = 0; i < numLimbs; ++i) {
+    const n = (0xffff - (limbs[i] || 0)) + carry;
+    result.push(n % 0x10000);
+    carry = Math.floor(n / 0x10000);
+  }
+  const topBits = width % 16;
+  if (topBits) {
+    result[numLimbs - 1] %= Math.pow(2, topBits);
+  }
+  return result;
+}
+
+/** Converts an arbitrary precision unsigned integer to a string of binary digits. */
+function toBinaryDigits(limbs: number[]): string {
+  let digits = '';
+  for (let i = limbs.length - 1; i >= 0; --i) {
+    digits += ('0000000000000000' + limbs[i].toString(2)).slice(-16);
+  }
+  const firstOne = digits.indexOf('1');
+  return (firstOne < 0) ? '0' : digits.substr(firstOne);
+}
+
+/** Converts a string of binary digits to a string of digits in base 8 or 16. */
+function regroupBinaryDigits(binary: string, radix: number): string {
+  const bitsPerDigit = (radix === 16) ? 4 : 3;
+  const padding = (bitsPerDigit - (binary.length % bitsPerDigit)) % bitsPerDigit;
+  const padded = '000'.substr(0, padding) + binary;
+  let digits = '';
+  for (let i = 0; i < padded.length; i += bitsPerDigit) {
+    digits += parseInt(padded.substr(i, bitsPerDigit), 2).toString(radix);
+  }
+  return digits;
+}
+
+/**
+ * Formats the value of an integer variable the same way the debugger would, without any
+ * loss of precision (so values of 64-bit and 128-bit types are handled correctly).
+ *
+ * @param value Value of the variable in decimal format, e.g. `-42`.
+ * @param typeName Type of the variable as reported by the debugger, e.g. `unsigned int`.
+ * @param formatSpec The format the value should be converted to.
+ * @returns The formatted value, or `undefined` if the value couldn't be formatted (because the
+ *          type isn't a known integer type, or the value isn't a decimal integer, or the value is
+ *          negative and the width of the type is unknown), in which case the debugger should be
+ *          asked to format the value instead.
+ */
+export function formatIntegerValue(
+  value: string, typeName: string, formatSpec: WatchFormatSpec): string {
+  if ((value === undefined) || (typeName === undefined)) {
+    return undefined;
+  }
+  const type = normalizeTypeName(typeName);
+  if (!integerTypeWidths.has(type)) {
+    return undefined;
+  }
+  const match = /^(-)?(\d+)$/.exec(value.trim());
+  if (!match) {
+    return undefined;
+  }
+  const isNegative = (match[1] !== undefined) && (match[2].replace(/0/g, '') !== '');
+  const width = integerTypeWidths.get(type);
+
+  switch (formatSpec) {
+    case WatchFormatSpec.Default:
+      if (characterTypes.has(type)) {
+        // the debugger displays both the numeric value and the character
+        return undefined;
+      }
+      // fall through
+    case WatchFormatSpec.Decimal:
+      return (isNegative ? '-' : '') + (match[2].replace(/^0+(?=\d)/, ''));
+  }
+
+  if (isNegative && (width === undefined)) {
+    return undefined;
+  }
+  let limbs = parseDecimalDigits(match[2]);
+  if (isNegative) {
+    limbs = negate(limbs, width);
+  }
+  const binary = toBinaryDigits(limbs);
+
+  switch (formatSpec) {
+    case WatchFormatSpec.Binary:
+      return binary;
+    case WatchFormatSpec.Hexadecimal:
+      return '0x' + regroupBinaryDigits(binary, 16);
+    case WatchFormatSpec.Octal:
+      return (binary === '0') ? '0' : '0' + regroupBinaryDigits(binary, 8);
+    default:
+      return undefined;
+  }
+}
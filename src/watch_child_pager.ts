@@ -0,0 +1,212 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+import DebugSession from './debug_session';
+import { IWatchChildInfo, IWatchChildRange, VariableDetailLevel } from './types';
+
+interface IChildPage {
+  /** Index of the page, the first child in the page is at `index * pageSize`. */
+  index: number;
+  /** Resolved once the children in the page have been retrieved from the debugger. */
+  loaded: Promise<IWatchChildInfo[]>;
+  /** The children in the page, `undefined` until the page is loaded. */
+  children: IWatchChildInfo[];
+}
+
+/**
+ * Provides windowed access to the children of a watch that may have far too many children to
+ * retrieve all at once (e.g. a `std::vector` with millions of elements).
+ *
+ * Children are retrieved from the debugger in fixed-size pages, and only a limited number of
+ * pages is kept around, the least recently used pages are evicted once that limit is exceeded.
+ * The debugger creates a variable object for every child that's retrieved, so the variable objects
+ * of the children in evicted pages are deleted to keep the memory usage of the debugger bounded.
+ * The pager also keeps track of the direction in which the children are being traversed and
+ * prefetches the next page in that direction.
+ *
+ * Watches that rely on Python-based visualizers (dynamic watches) don't report their child count
+ * up front, the pager discovers where the children end by following the `has_more` flag reported
+ * along with each page.
+ */
+export class WatchChildPager {
+  private pages = new Map<number, IChildPage>(); // in least to most recently used order
+  // index of the page one past the last page of children, undefined until the end is found
+  private endPage: number;
+  // total number of children, undefined until the end is found
+  private _childCount: number;
+  // range of pages covered by the most recent request, these are never evicted
+  private lastRequestedPage: number = -1;
+  private lastRequestedEndPage: number = -1;
+  private pageSize: number;
+  private maxPages: number;
+  private readAhead: boolean;
+  private detail: VariableDetailLevel;
+
+  /**
+   * @param debugSession The session that created the watch.
+   * @param watchId Identifier of the watch whose children will be retrieved.
+   * @param options.pageSize Number of children to retrieve from the debugger at a time.
+   *                         *Default*: `100`.
+   * @param options.maxPages Maximum number of pages to keep around. *Default*: `10`.
+   * @param options.readAhead Set to `false` to disable prefetching. *Default*: `true`.
+   * @param options.detail Specifies what information should be retrieved for each child.
+   *                       *Default*: [[VariableDetailLevel.All]].
+   * @param options.childCount Number of children the watch has, if omitted (or if the watch is
+   *                           dynamic) the pager will find out as it goes.
+   */
+  constructor(
+    private debugSession: DebugSession,
+    private watchId: string,
+    options?: {
+      pageSize?: number;
+      maxPages?: number;
+      readAhead?: boolean;
+      detail?: VariableDetailLevel;
+      childCount?: number;
+    }
+  ) {
+    this.pageSize = (options && options.pageSize) || 100;
+    this.maxPages = Math.max((options && options.maxPages) || 10, 1);
+    this.readAhead = !options || (options.readAhead !== false);
+    this.detail = (options && (options.detail !== undefined)) ? options.detail : VariableDetailLevel.All;
+    if (options && (options.childCount !== undefined)) {
+      this._childCount = options.childCount;
+      this.endPage = Math.ceil(options.childCount / this.pageSize);
+    }
+  }
+
+  /** Total number of children, `undefined` if it's not known yet. */
+  get childCount(): number {
+    return this._childCount;
+  }
+
+  /** Number of pages that are currently loaded (or being loaded). */
+  get cachedPageCount(): number {
+    return this.pages.size;
+  }
+
+  /**
+   * Retrieves a range of children.
+   *
+   * @param from Zero-based index of the first child to retrieve.
+   * @param count Number of children to retrieve.
+   * @returns A promise that will be resolved with the children in the requested range, fewer
+   *          children than requested will be returned if the range extends past the last child.
+   */
+  getChildren(from: number, count: number): Promise<IWatchChildInfo[]> {
+    if (count <= 0) {
+      return Promise.resolve([]);
+    }
+    const firstPage = Math.floor(from / this.pageSize);
+    let lastPage = Math.floor((from + count - 1) / this.pageSize);
+    if (this.endPage !== undefined) {
+      lastPage = Math.min(lastPage, this.endPage - 1);
+    }
+    const requestedPages: number[] = [];
+    for (let i = firstPage; i <= lastPage; ++i) {
+      requestedPages.push(i);
+    }
+    const direction = (firstPage >= this.lastRequestedPage) ? 1 : -1;
+    this.lastRequestedPage = firstPage;
+    this.lastRequestedEndPage = lastPage + 1;
+
+    // all the missing pages can be retrieved in one go
+    const pagesLoaded = this.debugSession.pipelineCommands(
+      () => requestedPages.map((pageIndex: number) => this.getPage(pageIndex).loaded)
+    );
+
+    if (this.readAhead) {
+      const nextPage = (direction > 0) ? lastPage + 1 : firstPage - 1;
+      if ((nextPage >= 0) && ((this.endPage === undefined) || (nextPage < this.endPage))) {
+        // errors will be reported if/when the page is actually requested
+        this.getPage(nextPage).loaded.catch(() => {});
+      }
+    }
+
+    return Promise.all(pagesLoaded)
+    .then((pages: IWatchChildInfo[][]) => {
+      const children = pages.reduce((all, page) => all.concat(page), <IWatchChildInfo[]> []);
+      const start = from - (firstPage * this.pageSize);
+      return children.slice(start, start + count);
+    });
+  }
+
+  /**
+   * Deletes the variable objects of all the children retrieved by the pager.
+   *
+   * @returns A promise that will be resolved once all the variable objects have been deleted.
+   */
+  dispose(): Promise<void> {
+    const pages: IChildPage[] = [];
+    this.pages.forEach((page: IChildPage) => pages.push(page));
+    this.pages.clear();
+    return this.deletePages(pages);
+  }
+
+  /** Retrieves a page from the cache (loading it if necessary), and marks it as recently used. */
+  private getPage(pageIndex: number): IChildPage {
+    let page = this.pages.get(pageIndex);
+    if (page) {
+      // move the page to the end of the LRU order
+      this.pages.delete(pageIndex);
+      this.pages.set(pageIndex, page);
+      return page;
+    }
+
+    const from = pageIndex * this.pageSize;
+    page = { index: pageIndex, loaded: null, children: undefined };
+    page.loaded = this.debugSession.getWatchChildRange(
+      this.watchId, from, from + this.pageSize, this.detail
+    )
+    .then((range: IWatchChildRange) => {
+      page.children = range.children;
+      if ((range.children.length < this.pageSize) && !range.hasMoreChildren) {
+        this.endPage = pageIndex + 1;
+        this._childCount = from + range.children.length;
+      }
+      this.evictPages();
+      return range.children;
+    }, (err: Error) => {
+      // don't cache failures
+      if (this.pages.get(pageIndex) === page) {
+        this.pages.delete(pageIndex);
+      }
+      throw err;
+    });
+    this.pages.set(pageIndex, page);
+    return page;
+  }
+
+  /** Evicts the least recently used pages until the number of cached pages is within limits. */
+  private evictPages(): void {
+    const evicted: IChildPage[] = [];
+    let numToEvict = this.pages.size - this.maxPages;
+    this.pages.forEach((page: IChildPage) => {
+      // pages that are still loading may be needed by a pending request
+      const isPinned = (page.index >= this.lastRequestedPage) &&
+        (page.index < this.lastRequestedEndPage);
+      if ((numToEvict > 0) && page.children && !isPinned) {
+        evicted.push(page);
+        --numToEvict;
+      }
+    });
+    evicted.forEach((page: IChildPage) => { this.pages.delete(page.index); });
+    if (evicted.length) {
+      this.deletePages(evicted).catch(() => {});
+    }
+  }
+
+  private deletePages(pages: IChildPage[]): Promise<void> {
+    return Promise.all(pages.map((page: IChildPage) => page.loaded.then(
+      (children: IWatchChildInfo[]) => children,
+      () => <IWatchChildInfo[]> [] // nothing was created for a page that failed to load
+    )))
+    .then((pageChildren: IWatchChildInfo[][]) => {
+      const children = pageChildren.reduce((all, page) => all.concat(page), <IWatchChildInfo[]> []);
+      return this.debugSession.pipelineCommands(() => Promise.all(
+        children.map((child: IWatchChildInfo) => this.debugSession.removeWatch(child.id))
+      ));
+    })
+    .then(() => {});
+  }
+}
@@ -0,0 +1,126 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+import DebugSession from './debug_session';
+import { IWatchUpdateInfo, VariableDetailLevel } from './types';
+import { IWatchTreeNode } from './watch_tree';
+
+/**
+ * Automatically freezes watches that are unlikely to be worth updating after every stop, in
+ * order to reduce the time it takes the debugger to update the rest.
+ *
+ * A watch is frozen if it has more than a certain number of children (large aggregates are
+ * expensive to update, and the front-end usually displays only a few of their children), or if
+ * its value hasn't changed for a certain number of consecutive updates. Frozen watches are not
+ * updated by [[update]], but can still be updated on demand via [[refresh]] (e.g. when the user
+ * expands a watch), a watch that has been frozen for not changing is thawed again as soon as a
+ * refresh finds that it did change.
+ */
+export class WatchFreezePolicy {
+  // number of consecutive updates during which each unfrozen watch remained unchanged
+  private unchangedCounts = new Map<string, number>();
+  private maxChildCount: number;
+  private maxUnchangedUpdates: number;
+
+  /**
+   * @param debugSession The session whose watches should be managed.
+   * @param options.maxChildCount Watches with more children than this are frozen.
+   *                              *Default*: `1000`.
+   * @param options.maxUnchangedUpdates Watches that remain unchanged for this many consecutive
+   *                                    updates are frozen. *Default*: `10`.
+   */
+  constructor(
+    private debugSession: DebugSession,
+    options?: {
+      maxChildCount?: number;
+      maxUnchangedUpdates?: number;
+    }
+  ) {
+    this.maxChildCount = (options && (options.maxChildCount !== undefined)) ?
+      options.maxChildCount : 1000;
+    this.maxUnchangedUpdates = (options && (options.maxUnchangedUpdates !== undefined)) ?
+      options.maxUnchangedUpdates : 10;
+  }
+
+  /**
+   * Updates all the watches that aren't frozen, and then freezes any watches that should be
+   * frozen according to the policy. This should be called instead of `updateWatch('*')` every
+   * time the target stops.
+   *
+   * @param detail See [[DebugSession.updateWatch]].
+   * @returns A promise that will be resolved with the changelist returned by the debugger.
+   */
+  update(detail?: VariableDetailLevel): Promise<IWatchUpdateInfo[]> {
+    return this.debugSession.updateWatch('*', detail)
+    .then((updates: IWatchUpdateInfo[]) => {
+      const tree = this.debugSession.watchTree;
+      const changedWatches = new Set<string>();
+      updates.forEach((update: IWatchUpdateInfo) => {
+        let node = tree.getNode(update.id);
+        while (node && node.parent) {
+          node = node.parent;
+        }
+        if (node) {
+          changedWatches.add(node.id);
+        }
+      });
+
+      const watchesToFreeze: string[] = [];
+      const counts = new Map<string, number>();
+      tree.roots.forEach((watch: IWatchTreeNode) => {
+        if (watch.isFrozen) {
+          return;
+        }
+        const count = changedWatches.has(watch.id) ?
+          0 : (this.unchangedCounts.get(watch.id) || 0) + 1;
+        if ((watch.childCount > this.maxChildCount) || (count >= this.maxUnchangedUpdates)) {
+          watchesToFreeze.push(watch.id);
+        } else {
+          counts.set(watch.id, count);
+        }
+      });
+      // watches that were removed or frozen are dropped along with the old counts
+      this.unchangedCounts = counts;
+
+      return Promise.all(this.debugSession.pipelineCommands(
+        () => watchesToFreeze.map((id: string) => this.debugSession.setWatchFrozen(id, true))
+      ))
+      .then(() => updates);
+    });
+  }
+
+  /**
+   * Explicitly updates a watch, even if it's frozen.
+   *
+   * If the watch was frozen because it didn't change for a while, but has changed since, it will
+   * be unfrozen.
+   *
+   * @param id Identifier of the watch to update.
+   * @param detail See [[DebugSession.updateWatch]].
+   * @returns A promise that will be resolved with the changelist returned by the debugger.
+   */
+  refresh(id: string, detail?: VariableDetailLevel): Promise<IWatchUpdateInfo[]> {
+    return this.debugSession.updateWatch(id, detail)
+    .then((updates: IWatchUpdateInfo[]) => {
+      const watch = this.debugSession.watchTree.getNode(id);
+      if (updates.length && watch && !watch.parent && watch.isFrozen &&
+          (watch.childCount <= this.maxChildCount)) {
+        return this.thaw(id).then(() => updates);
+      }
+      return updates;
+    });
+  }
+
+  /**
+   * Unfreezes a watch, the watch may be frozen again by a subsequent [[update]] if it remains
+   * unchanged for long enough (or is too large).
+   *
+   * @param id Identifier of the watch to unfreeze.
+   */
+  thaw(id: string): Promise<void> {
+    return this.debugSession.setWatchFrozen(id, false)
+    .then(() => {
+      this.unchangedCounts.set(id, 0);
+    });
+  }
+}
@@ -0,0 +1,226 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+import DebugSession from './debug_session';
+import { IWatchInfo } from './types';
+import { IWatchNodeEvent, EVENT_WATCH_SCOPE_CHANGED } from './watch_tree';
+
+/** Options that can be passed to [[DebugSession.acquireWatch]]. */
+export interface IWatchHandleOptions {
+  threadId?: number;
+  threadGroup?: string;
+  frameLevel?: number;
+  frameAddress?: string;
+  isFloating?: boolean;
+}
+
+interface IWatchEntry {
+  watch: IWatchInfo;
+  isFloating: boolean;
+  // key identifying the expression and options the watch was created with
+  key: string;
+  handles: WatchHandle[];
+  // set once the watch went out of scope, such a watch can't be handed out again
+  isStale: boolean;
+}
+
+/**
+ * A reference to a watch obtained via [[DebugSession.acquireWatch]].
+ *
+ * The underlying watch is shared by all the handles acquired for the same expression (and
+ * options), and is destroyed once all those handles have been released. All the handles to a
+ * watch are released automatically if the watch goes out of scope (because the frame it was
+ * bound to is gone), or becomes obsolete.
+ */
+export class WatchHandle {
+  private _isReleased: boolean = false;
+
+  constructor(private registry: WatchHandleRegistry, private _watch: IWatchInfo) {
+  }
+
+  /** Identifier of the underlying watch. */
+  get id(): string {
+    return this._watch.id;
+  }
+
+  /** Information about the underlying watch as of the time it was created. */
+  get watch(): IWatchInfo {
+    return this._watch;
+  }
+
+  /** `true` once this handle has been released (explicitly or otherwise). */
+  get isReleased(): boolean {
+    return this._isReleased;
+  }
+
+  /** Releases this handle, releasing an already released handle has no effect. */
+  release(): void {
+    if (!this._isReleased) {
+      this._isReleased = true;
+      this.registry.releaseHandle(this);
+    }
+  }
+
+  /** @internal Marks the handle as released without notifying the registry. */
+  invalidate(): void {
+    this._isReleased = true;
+  }
+}
+
+/**
+ * Groups watch handles so they can all be released at once, e.g. when the UI panel displaying
+ * the locals of a frame is closed.
+ */
+export class WatchScope {
+  private handles: WatchHandle[] = [];
+  private isReleased: boolean = false;
+
+  constructor(private registry: WatchHandleRegistry) {
+  }
+
+  /**
+   * Acquires a handle to a watch for the given expression, the handle will be released along
+   * with the scope.
+   *
+   * See [[DebugSession.acquireWatch]].
+   */
+  acquireWatch(expression: string, options?: IWatchHandleOptions): Promise<WatchHandle> {
+    return this.registry.acquire(expression, options)
+    .then((handle: WatchHandle) => {
+      if (this.isReleased) {
+        // the scope was released while the watch was being created
+        handle.release();
+      } else {
+        this.handles.push(handle);
+      }
+      return handle;
+    });
+  }
+
+  /** Releases all the handles acquired via this scope. */
+  release(): void {
+    this.isReleased = true;
+    const handles = this.handles;
+    this.handles = [];
+    handles.forEach((handle: WatchHandle) => handle.release());
+  }
+}
+
+/**
+ * Keeps track of the watches created via [[DebugSession.acquireWatch]], and destroys them once
+ * they're no longer referenced by any handles.
+ *
+ * Watches are not destroyed as soon as they're released, instead they're collected and
+ * destroyed in one pipelined batch once the current turn of the event loop completes.
+ */
+export class WatchHandleRegistry {
+  // watches that have live handles keyed by watch identifier
+  private entries = new Map<string, IWatchEntry>();
+  // watches (that have live handles, or are being created) keyed by expression and options
+  private entriesByKey = new Map<string, Promise<IWatchEntry>>();
+  // identifiers of watches that should be destroyed in the next batch
+  private pendingDeletes = new Set<string>();
+
+  constructor(private debugSession: DebugSession) {
+    debugSession.watchTree.on(EVENT_WATCH_SCOPE_CHANGED, (e: IWatchNodeEvent) => {
+      const entry = this.entries.get(e.node.id);
+      // floating watches are reevaluated in whatever frame is current, so they can come back
+      // into scope, but a watch bound to a frame can't once that frame is gone
+      if (entry && (e.node.isObsolete || (!e.node.isInScope && !entry.isFloating))) {
+        entry.handles.forEach((handle: WatchHandle) => handle.invalidate());
+        entry.handles = [];
+        entry.isStale = true;
+        // subsequent requests for the same expression should get a new watch
+        this.entriesByKey.delete(entry.key);
+        this.scheduleDelete(entry);
+      }
+    });
+  }
+
+  /** Number of watches that have live handles. */
+  get watchCount(): number {
+    return this.entries.size;
+  }
+
+  /** Acquires a handle to a watch, see [[DebugSession.acquireWatch]]. */
+  acquire(expression: string, options?: IWatchHandleOptions): Promise<WatchHandle> {
+    const key = JSON.stringify([
+      expression,
+      options ? options.threadId : undefined,
+      options ? options.threadGroup : undefined,
+      options ? options.frameLevel : undefined,
+      options ? options.frameAddress : undefined,
+      options ? !!options.isFloating : false
+    ]);
+    let entryCreated = this.entriesByKey.get(key);
+    if (!entryCreated) {
+      entryCreated = this.debugSession.addWatch(expression, options)
+      .then((watch: IWatchInfo) => {
+        const entry: IWatchEntry = {
+          watch: watch,
+          isFloating: !!(options && options.isFloating),
+          key: key,
+          handles: [],
+          isStale: false
+        };
+        this.entries.set(watch.id, entry);
+        return entry;
+      }, (err: Error) => {
+        this.entriesByKey.delete(key);
+        throw err;
+      });
+      this.entriesByKey.set(key, entryCreated);
+    }
+    return entryCreated.then((entry: IWatchEntry) => {
+      if (entry.isStale || !this.entries.has(entry.watch.id)) {
+        // the watch was destroyed while this handle was being acquired, so start over
+        return this.acquire(expression, options);
+      }
+      // a watch that was released, but hasn't been destroyed yet, can be reused
+      this.pendingDeletes.delete(entry.watch.id);
+      const handle = new WatchHandle(this, entry.watch);
+      entry.handles.push(handle);
+      return handle;
+    });
+  }
+
+  /** @internal Called by [[WatchHandle.release]]. */
+  releaseHandle(handle: WatchHandle): void {
+    const entry = this.entries.get(handle.id);
+    if (entry) {
+      const index = entry.handles.indexOf(handle);
+      if (index >= 0) {
+        entry.handles.splice(index, 1);
+      }
+      if (entry.handles.length === 0) {
+        this.scheduleDelete(entry);
+      }
+    }
+  }
+
+  private scheduleDelete(entry: IWatchEntry): void {
+    if (this.pendingDeletes.size === 0) {
+      setImmediate(() => this.deletePendingWatches());
+    }
+    this.pendingDeletes.add(entry.watch.id);
+  }
+
+  private deletePendingWatches(): void {
+    const ids: string[] = [];
+    this.pendingDeletes.forEach((id: string) => {
+      const entry = this.entries.get(id);
+      this.entries.delete(id);
+      if (!entry.isStale) {
+        this.entriesByKey.delete(entry.key);
+      }
+      ids.push(id);
+    });
+    this.pendingDeletes.clear();
+    this.debugSession.pipelineCommands(() => {
+      ids.forEach((id: string) => {
+        // the debugger may have already discarded an obsolete watch
+        this.debugSession.removeWatch(id).catch(() => {});
+      });
+    });
+  }
+}
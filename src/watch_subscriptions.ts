@@ -0,0 +1,168 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+import DebugSession from './debug_session';
+import { IWatchUpdateInfo, VariableDetailLevel } from './types';
+import { IWatchTreeNode, IWatchUpdatedEvent, EVENT_WATCH_UPDATED } from './watch_tree';
+
+/**
+ * Listener function passed to [[DebugSession.subscribeWatch]], it's invoked with each change
+ * to the watch (or one of its children).
+ */
+export type WatchUpdateListener = (update: IWatchUpdateInfo) => void;
+
+/** Returned by [[DebugSession.subscribeWatch]]. */
+export interface IWatchSubscription {
+  /** Stops the listener from receiving any further changes. */
+  unsubscribe(): void;
+}
+
+/**
+ * Keeps track of the listeners registered via [[DebugSession.subscribeWatch]], and updates the
+ * subscribed watches whenever the target stops.
+ *
+ * The debugger reports each change to a watch only to the first update that sees it, so the
+ * listeners are notified of the changes applied to the [[WatchTree]] by every update (e.g. by
+ * [[DebugSession.updateVisibleWatches]] or a [[WatchFreezePolicy]]), not just the updates
+ * performed here. After a stop the subscribed watches that the other updates didn't cover are
+ * updated once, however many listeners are subscribed to them (or to their ancestors).
+ */
+export class WatchSubscriptionManager {
+  // listeners keyed by the identifier of the watch (or child) they're subscribed to
+  private listeners = new Map<string, Set<WatchUpdateListener>>();
+  // set when the target resumes execution, nothing can change until it does
+  private hasTargetRun: boolean = false;
+
+  constructor(private debugSession: DebugSession) {
+    debugSession.watchTree.on(EVENT_WATCH_UPDATED, (e: IWatchUpdatedEvent) => {
+      if (this.listeners.size > 0) {
+        this.notifyListeners(e.update);
+      }
+    });
+  }
+
+  /** Subscribes a listener to a watch, see [[DebugSession.subscribeWatch]]. */
+  subscribe(id: string, listener: WatchUpdateListener): IWatchSubscription {
+    let listeners = this.listeners.get(id);
+    if (!listeners) {
+      listeners = new Set<WatchUpdateListener>();
+      this.listeners.set(id, listeners);
+    }
+    listeners.add(listener);
+    return {
+      unsubscribe: () => {
+        const currentListeners = this.listeners.get(id);
+        if (currentListeners) {
+          currentListeners.delete(listener);
+          if (currentListeners.size === 0) {
+            this.listeners.delete(id);
+          }
+        }
+      }
+    };
+  }
+
+  /** Should be called when the target resumes execution. */
+  onTargetRunning(): void {
+    this.hasTargetRun = true;
+  }
+
+  /**
+   * Should be called when the target stops, updates the subscribed watches that are still stale
+   * once the updates that were already requested since the stop have completed. The listeners
+   * are notified as the changes are applied to the watch tree.
+   *
+   * @param pendingUpdates Promise that will be resolved once the watch updates requested since
+   *                       the target stopped have completed.
+   * @returns A promise that will be resolved once all the listeners have been notified.
+   */
+  onTargetStopped(pendingUpdates: Promise<void>): Promise<void> {
+    if (!this.hasTargetRun || (this.listeners.size === 0)) {
+      return Promise.resolve();
+    }
+    this.hasTargetRun = false;
+
+    return pendingUpdates.then(() => {
+      const ids = this.getWatchesToUpdate();
+      return Promise.all(this.debugSession.pipelineCommands(() => ids.map((id: string) => {
+        return this.debugSession.updateWatch(id, VariableDetailLevel.All)
+        .catch((err: Error) => {
+          if (this.debugSession.logger) {
+            this.debugSession.logger.warn(err, `Failed to update subscribed watch ${id}.`);
+          }
+          return <IWatchUpdateInfo[]> [];
+        });
+      })));
+    })
+    .then(() => undefined);
+  }
+
+  /**
+   * Figures out the smallest set of watches that must be updated in order to find out about all
+   * the changes the listeners are interested in.
+   */
+  private getWatchesToUpdate(): string[] {
+    const tree = this.debugSession.watchTree;
+    const candidates = new Set<string>();
+    this.listeners.forEach((listeners: Set<WatchUpdateListener>, id: string) => {
+      const node = tree.getNode(id);
+      if (!node) {
+        // the watch was removed
+        this.listeners.delete(id);
+      } else if (node.isStale && !this.isObsolete(node)) {
+        candidates.add(id);
+      }
+    });
+    const ids: string[] = [];
+    candidates.forEach((id: string) => {
+      // frozen nodes aren't updated along with their ancestors
+      for (let node = tree.getNode(id); node.parent && !node.isFrozen; node = node.parent) {
+        if (candidates.has(node.parent.id)) {
+          return; // will be updated along with the ancestor
+        }
+      }
+      ids.push(id);
+    });
+    return ids;
+  }
+
+  /**
+   * Checks if a node belongs to a watch that can no longer change. A watch that's merely out of
+   * scope can still change, since a function called again from the same call site gets the same
+   * frame, which brings its watches back into scope.
+   */
+  private isObsolete(node: IWatchTreeNode): boolean {
+    let root = node;
+    while (root.parent) {
+      root = root.parent;
+    }
+    return root.isObsolete;
+  }
+
+  /**
+   * Passes on a change to the listeners subscribed to the changed watch (or child) and its
+   * ancestors, each listener is notified only once.
+   */
+  private notifyListeners(update: IWatchUpdateInfo): void {
+    const notified = new Set<WatchUpdateListener>();
+    const notify = (id: string) => {
+      const listeners = this.listeners.get(id);
+      if (listeners) {
+        listeners.forEach((listener: WatchUpdateListener) => {
+          if (!notified.has(listener)) {
+            notified.add(listener);
+            listener(update);
+          }
+        });
+      }
+    };
+    const node = this.debugSession.watchTree.getNode(update.id);
+    if (node) {
+      for (let current = node; current; current = current.parent) {
+        notify(current.id);
+      }
+    } else {
+      notify(update.id);
+    }
+  }
+}
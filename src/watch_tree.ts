@@ -0,0 +1,437 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+import * as events from 'events';
+import { IWatchInfo, IWatchChildInfo, IWatchUpdateInfo } from './types';
+
+/**
+  * Emitted when the value of a watch (or one of its children) changes.
+  *
+  * Listener function should have the signature:
+  * ~~~
+  * (e: [[IWatchValueChangedEvent]]) => void
+  * ~~~
+  * @event
+  */
+export const EVENT_WATCH_VALUE_CHANGED: string = 'watchvalue';
+/**
+  * Emitted when the type of a watch (or one of its children) changes, when that happens all the
+  * children of the node are discarded.
+  *
+  * Listener function should have the signature:
+  * ~~~
+  * (e: [[IWatchNodeEvent]]) => void
+  * ~~~
+  * @event
+  */
+export const EVENT_WATCH_TYPE_CHANGED: string = 'watchtype';
+/**
+  * Emitted when a watch (or one of its children) goes in or out of scope, or becomes obsolete.
+  *
+  * Listener function should have the signature:
+  * ~~~
+  * (e: [[IWatchNodeEvent]]) => void
+  * ~~~
+  * @event
+  */
+export const EVENT_WATCH_SCOPE_CHANGED: string = 'watchscope';
+/**
+  * Emitted when children are added to, or removed from, a watch (or one of its children).
+  *
+  * Listener function should have the signature:
+  * ~~~
+  * (e: [[IWatchChildrenChangedEvent]]) => void
+  * ~~~
+  * @event
+  */
+export const EVENT_WATCH_CHILDREN_CHANGED: string = 'watchchildren';
+/**
+  * Emitted when a watch is removed from the tree.
+  *
+  * Listener function should have the signature:
+  * ~~~
+  * (e: [[IWatchNodeEvent]]) => void
+  * ~~~
+  * @event
+  */
+export const EVENT_WATCH_REMOVED: string = 'watchremove';
+/**
+  * Emitted for each entry in the changelist of a watch update once the entry has been applied to
+  * the tree, whichever call to [[DebugSession.updateWatch]] retrieved the changelist.
+  *
+  * Listener function should have the signature:
+  * ~~~
+  * (e: [[IWatchUpdatedEvent]]) => void
+  * ~~~
+  * @event
+  */
+export const EVENT_WATCH_UPDATED: string = 'watchupdate';
+
+/** A watch, or a child of a watch, mirrored by a [[WatchTree]]. */
+export interface IWatchTreeNode {
+  /** Identifier of the variable object the node mirrors. */
+  id: string;
+  /** The parent of this node, `null` for a watch. */
+  parent: IWatchTreeNode;
+  /** Position of this node within the children of its parent, `undefined` for a watch. */
+  index: number;
+  /**
+   * The watch expression for a watch, or the expression the front-end should display to identify
+   * a child.
+   */
+  expression: string;
+  expressionType: string;
+  value: string;
+  childCount: number;
+  hasMoreChildren: boolean;
+  isDynamic: boolean;
+  displayHint: string;
+  threadId: number;
+  isInScope: boolean;
+  isObsolete: boolean;
+  /**
+   * `true` if the target has stopped since the node was last updated, so the node may not
+   * reflect the current state of the target.
+   */
+  isStale: boolean;
+  /**
+   * `true` if the node belongs to a floating watch, i.e. one that's reevaluated within whatever
+   * frame is current rather than being bound to the frame it was created in.
+   */
+  isFloating: boolean;
+  /** `true` if the node won't be updated implicitly, see [[DebugSession.setWatchFrozen]]. */
+  isFrozen: boolean;
+  /**
+   * Children of the node that have been retrieved from the debugger so far (indexed by their
+   * position within the parent), `undefined` if the children haven't been retrieved yet.
+   */
+  children: IWatchTreeNode[];
+}
+
+export interface IWatchNodeEvent {
+  node: IWatchTreeNode;
+}
+
+export interface IWatchValueChangedEvent extends IWatchNodeEvent {
+  oldValue: string;
+}
+
+export interface IWatchUpdatedEvent extends IWatchNodeEvent {
+  /** The changelist entry that was applied to the node. */
+  update: IWatchUpdateInfo;
+}
+
+export interface IWatchChildrenChangedEvent extends IWatchNodeEvent {
+  /** Children that were added to the node. */
+  added: IWatchTreeNode[];
+  /** Children that were removed from the node. */
+  removed: IWatchTreeNode[];
+}
+
+/**
+ * Mirrors the variable objects created via a [[DebugSession]], along with any of their children
+ * that have been retrieved, so that front-ends don't have to reconcile the flat changelists
+ * returned by [[DebugSession.updateWatch]] with the children they've already fetched.
+ *
+ * The tree is kept up to date by the debug session that owns it, and emits an event for each
+ * individual change so that front-ends can repaint only the nodes that actually changed.
+ */
+export class WatchTree extends events.EventEmitter {
+  // all the nodes in the tree keyed by variable object identifier
+  private nodes = new Map<string, IWatchTreeNode>();
+  private _roots: IWatchTreeNode[] = [];
+
+  /** The watches in the tree, in the order they were created. */
+  get roots(): IWatchTreeNode[] {
+    return this._roots;
+  }
+
+  /** Total number of nodes in the tree. */
+  get size(): number {
+    return this.nodes.size;
+  }
+
+  /**
+   * Looks up a node in the tree.
+   *
+   * @param id Identifier of a variable object.
+   * @returns The matching node, or `undefined` if the variable object isn't in the tree.
+   */
+  getNode(id: string): IWatchTreeNode {
+    return this.nodes.get(id);
+  }
+
+  /**
+   * Adds a newly created watch to the tree.
+   *
+   * @param expression The watch expression.
+   * @param watch The newly created watch.
+   * @param isFloating `true` if the watch is floating, see [[IWatchTreeNode.isFloating]].
+   */
+  addWatch(expression: string, watch: IWatchInfo, isFloating: boolean = false): IWatchTreeNode {
+    const node = this.createNode(watch, expression, null);
+    node.isFloating = isFloating;
+    this._roots.push(node);
+    return node;
+  }
+
+  /**
+   * Adds children retrieved from the debugger to a node in the tree (if the node is not in the
+   * tree the children are ignored).
+   *
+   * @param id Identifier of the parent variable object.
+   * @param children The retrieved children.
+   * @param from Position of the first retrieved child within the parent.
+   */
+  setChildren(id: string, children: IWatchChildInfo[], from: number = 0): void {
+    const parent = this.nodes.get(id);
+    if (!parent) {
+      return;
+    }
+    if (!parent.children) {
+      parent.children = [];
+    }
+    const added: IWatchTreeNode[] = [];
+    const removed: IWatchTreeNode[] = [];
+    children.forEach((child: IWatchChildInfo, i: number) => {
+      const existing = parent.children[from + i];
+      if (existing && (existing.id === child.id)) {
+        this.updateNode(existing, child);
+      } else {
+        if (existing) {
+          this.removeNode(existing);
+          removed.push(existing);
+        }
+        const node = this.createNode(child, child.expression, parent, from + i);
+        parent.children[from + i] = node;
+        added.push(node);
+      }
+    });
+    if (added.length || removed.length) {
+      this.emitChildrenChanged(parent, added, removed);
+    }
+  }
+
+  /**
+   * Applies the changes reported by the debugger after a watch update to the tree.
+   *
+   * @param updates Changelist returned by [[DebugSession.updateWatch]].
+   */
+  applyUpdates(updates: IWatchUpdateInfo[]): void {
+    updates.forEach((update: IWatchUpdateInfo) => {
+      const node = this.nodes.get(update.id);
+      if (node) {
+        this.applyUpdate(node, update);
+        this.emit(EVENT_WATCH_UPDATED, <IWatchUpdatedEvent> { node, update });
+      }
+    });
+  }
+
+  /** Sets the value of a node (if it's in the tree). */
+  setValue(id: string, value: string): void {
+    const node = this.nodes.get(id);
+    if (node && (node.value !== value)) {
+      const oldValue = node.value;
+      node.value = value;
+      this.emit(EVENT_WATCH_VALUE_CHANGED, <IWatchValueChangedEvent> { node, oldValue });
+    }
+  }
+
+  /** Removes a watch, or a child of a watch, (along with all its children) from the tree. */
+  removeWatch(id: string): void {
+    const node = this.nodes.get(id);
+    if (!node) {
+      return;
+    }
+    this.removeNode(node);
+    if (node.parent) {
+      if (node.parent.children && (node.parent.children[node.index] === node)) {
+        node.parent.children[node.index] = undefined;
+      }
+      this.emitChildrenChanged(node.parent, [], [node]);
+    } else {
+      this._roots.splice(this._roots.indexOf(node), 1);
+      this.emit(EVENT_WATCH_REMOVED, <IWatchNodeEvent> { node });
+    }
+  }
+
+  /** Sets the frozen flag of a node (if it's in the tree). */
+  setFrozen(id: string, isFrozen: boolean): void {
+    const node = this.nodes.get(id);
+    if (node) {
+      node.isFrozen = isFrozen;
+    }
+  }
+
+  /** Marks all the nodes in the tree as stale. */
+  markStale(): void {
+    this.nodes.forEach((node: IWatchTreeNode) => { node.isStale = true; });
+  }
+
+  /**
+   * Marks a node, along with all its descendants, as up to date. Frozen descendants are left
+   * alone since the debugger doesn't update them along with their ancestors.
+   *
+   * @param id Identifier of a variable object, if omitted all the nodes in the tree (except the
+   *           frozen ones) are marked.
+   */
+  markFresh(id?: string): void {
+    if (id === undefined) {
+      this._roots.forEach((node: IWatchTreeNode) => {
+        if (!node.isFrozen) {
+          this.markSubtreeFresh(node);
+        }
+      });
+    } else {
+      const node = this.nodes.get(id);
+      if (node) {
+        this.markSubtreeFresh(node);
+      }
+    }
+  }
+
+  /** Removes all the nodes from the tree. */
+  clear(): void {
+    const roots = this._roots;
+    this._roots = [];
+    this.nodes.clear();
+    roots.forEach((node: IWatchTreeNode) => {
+      this.emit(EVENT_WATCH_REMOVED, <IWatchNodeEvent> { node });
+    });
+  }
+
+  private createNode(
+    info: IWatchInfo, expression: string, parent: IWatchTreeNode, index?: number): IWatchTreeNode {
+    const node: IWatchTreeNode = {
+      id: info.id,
+      parent: parent,
+      index: index,
+      expression: expression,
+      expressionType: info.expressionType,
+      value: info.value,
+      childCount: info.childCount,
+      hasMoreChildren: info.hasMoreChildren,
+      isDynamic: info.isDynamic,
+      displayHint: info.displayHint,
+      threadId: info.threadId,
+      isInScope: true,
+      isObsolete: false,
+      isStale: false,
+      isFloating: parent ? parent.isFloating : false,
+      isFrozen: !!(<IWatchChildInfo> info).isFrozen,
+      children: undefined
+    };
+    this.nodes.set(node.id, node);
+    return node;
+  }
+
+  private updateNode(node: IWatchTreeNode, info: IWatchInfo): void {
+    node.expressionType = info.expressionType;
+    node.childCount = info.childCount;
+    node.hasMoreChildren = info.hasMoreChildren;
+    node.isDynamic = info.isDynamic;
+    node.displayHint = info.displayHint;
+    if (info.value !== undefined) {
+      this.setValue(node.id, info.value);
+    }
+  }
+
+  /** Removes the descendants of a node, and the node itself, from the id map. */
+  private removeNode(node: IWatchTreeNode): void {
+    this.removeChildren(node, 0);
+    this.nodes.delete(node.id);
+  }
+
+  /**
+   * Discards the children of a node starting at the given position.
+   *
+   * @returns The discarded children.
+   */
+  private removeChildren(node: IWatchTreeNode, from: number): IWatchTreeNode[] {
+    if (!node.children || (node.children.length <= from)) {
+      return [];
+    }
+    const removed = node.children.splice(from).filter((child) => child !== undefined);
+    removed.forEach((child: IWatchTreeNode) => { this.removeNode(child); });
+    return removed;
+  }
+
+  private markSubtreeFresh(node: IWatchTreeNode): void {
+    node.isStale = false;
+    if (node.children) {
+      node.children.forEach((child: IWatchTreeNode) => {
+        if (child && !child.isFrozen) {
+          this.markSubtreeFresh(child);
+        }
+      });
+    }
+  }
+
+  private emitChildrenChanged(
+    node: IWatchTreeNode, added: IWatchTreeNode[], removed: IWatchTreeNode[]): void {
+    this.emit(EVENT_WATCH_CHILDREN_CHANGED, <IWatchChildrenChangedEvent> { node, added, removed });
+  }
+
+  private applyUpdate(node: IWatchTreeNode, update: IWatchUpdateInfo): void {
+    if ((update.isObsolete !== node.isObsolete) || (update.isInScope !== node.isInScope)) {
+      node.isInScope = update.isInScope;
+      node.isObsolete = update.isObsolete;
+      this.emit(EVENT_WATCH_SCOPE_CHANGED, <IWatchNodeEvent> { node });
+    }
+
+    if (update.hasTypeChanged) {
+      // the debugger discards all the children of a variable object whose type changed
+      const removed = this.removeChildren(node, 0);
+      node.children = undefined;
+      node.expressionType = update.expressionType;
+      if (update.childCount !== undefined) {
+        node.childCount = update.childCount;
+      }
+      this.emit(EVENT_WATCH_TYPE_CHANGED, <IWatchNodeEvent> { node });
+      if (removed.length) {
+        this.emitChildrenChanged(node, [], removed);
+      }
+    } else if (update.childCount !== undefined) {
+      // a dynamic variable object may lose children, the debugger discards those
+      node.childCount = update.childCount;
+      const removed = this.removeChildren(node, update.childCount);
+      if (removed.length) {
+        this.emitChildrenChanged(node, [], removed);
+      }
+    }
+
+    node.hasMoreChildren = update.hasMoreChildren;
+    if (update.isDynamic !== undefined) {
+      node.isDynamic = update.isDynamic;
+    }
+    if (update.displayHint !== undefined) {
+      node.displayHint = update.displayHint;
+    }
+
+    // values are only reported if they were requested
+    if (update.value !== undefined) {
+      this.setValue(node.id, update.value);
+    }
+
+    if (update.newChildren && update.newChildren.length) {
+      if (!node.children) {
+        node.children = [];
+      }
+      // the new children follow the ones the node had before, which may have been retrieved only
+      // partially (e.g. by a WatchChildPager), so their positions can't be based on node.children
+      let firstIndex: number;
+      if (update.childCount !== undefined) {
+        firstIndex = update.childCount - update.newChildren.length;
+      } else {
+        firstIndex = node.childCount || 0;
+        node.childCount = firstIndex + update.newChildren.length;
+      }
+      const added = update.newChildren.map((child: IWatchChildInfo, i: number) => {
+        const childNode = this.createNode(child, child.expression, node, firstIndex + i);
+        node.children[firstIndex + i] = childNode;
+        return childNode;
+      });
+      this.emitChildrenChanged(node, added, []);
+    }
+  }
+}
@@ -0,0 +1,89 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+require('source-map-support').install();
+
+import * as chai from 'chai';
+import {
+  Address, IAddressRange, getRangeLength, isAddressInRange, intersectRanges, findRange
+} from '../lib/address';
+
+// aliases
+var expect = chai.expect;
+
+function range(begin: string, end: string): IAddressRange {
+  return { begin: Address.parse(begin), end: Address.parse(end) };
+}
+
+describe("Addresses", () => {
+  describe("Address", () => {
+    it("parses hex and decimal addresses", () => {
+      expect(Address.parse('0x00000000004005d4').toString()).to.equal('0x4005d4');
+      expect(Address.parse('0x00007fffffffe0a0').toString()).to.equal('0x7fffffffe0a0');
+      expect(Address.parse('4195796').toString()).to.equal('0x4005d4');
+      expect(Address.parse('0x0').toNumber()).to.equal(0);
+    });
+
+    it("parses 64-bit addresses without losing precision", () => {
+      const address = Address.parse('0xffffffffff600000');
+      expect(address.high).to.equal(0xffffffff);
+      expect(address.low).to.equal(0xff600000);
+      expect(address.toString()).to.equal('0xffffffffff600000');
+      expect(Address.parse('18446744073709551615').toString()).to.equal('0xffffffffffffffff');
+    });
+
+    it("rejects invalid addresses", () => {
+      expect(Address.parse('<PENDING>')).to.be.undefined;
+      expect(Address.parse('0x10000000000000000')).to.be.undefined;
+      expect(Address.parse('18446744073709551616')).to.be.undefined;
+    });
+
+    it("adds and subtracts offsets across the 32-bit boundary", () => {
+      const address = Address.parse('0xfffffff0');
+      expect(address.add(0x20).toString()).to.equal('0x100000010');
+      expect(address.add(0x20).add(-0x20).equals(address)).to.be.true;
+      expect(address.add(0x20).subtract(address)).to.equal(0x20);
+      expect(address.subtract(address.add(0x20))).to.equal(-0x20);
+      expect(Address.parse('0xffffffffffffffff').add(1).toString()).to.equal('0x0');
+    });
+
+    it("sorts addresses", () => {
+      const addresses = ['0x100000000', '0x10', '0xffffffff', '0x1'].map(Address.parse);
+      expect(addresses.sort(Address.compare).map(String)).to.deep.equal(
+        ['0x1', '0x10', '0xffffffff', '0x100000000']
+      );
+    });
+  });
+
+  describe("Address ranges", () => {
+    it("computes the length of a range", () => {
+      expect(getRangeLength(range('0x7ffff000', '0x80001000'))).to.equal(0x2000);
+    });
+
+    it("checks if an address is in a range", () => {
+      const r = range('0x1000', '0x2000');
+      expect(isAddressInRange(Address.parse('0x1000'), r)).to.be.true;
+      expect(isAddressInRange(Address.parse('0x1fff'), r)).to.be.true;
+      expect(isAddressInRange(Address.parse('0x2000'), r)).to.be.false;
+      expect(isAddressInRange(Address.parse('0xfff'), r)).to.be.false;
+    });
+
+    it("intersects ranges", () => {
+      const overlap = intersectRanges(range('0x1000', '0x2000'), range('0x1800', '0x3000'));
+      expect(overlap.begin.toString()).to.equal('0x1800');
+      expect(overlap.end.toString()).to.equal('0x2000');
+      expect(intersectRanges(range('0x1000', '0x2000'), range('0x2000', '0x3000'))).to.be.undefined;
+    });
+
+    it("finds the range that contains an address", () => {
+      const ranges = [
+        range('0x1000', '0x2000'), range('0x3000', '0x4000'), range('0x100000000', '0x100001000')
+      ];
+      expect(findRange(ranges, Address.parse('0x1800'))).to.equal(0);
+      expect(findRange(ranges, Address.parse('0x3000'))).to.equal(1);
+      expect(findRange(ranges, Address.parse('0x100000fff'))).to.equal(2);
+      expect(findRange(ranges, Address.parse('0x2000'))).to.equal(-1);
+      expect(findRange(ranges, Address.parse('0x0'))).to.equal(-1);
+    });
+  });
+});
@@ -6,6 +6,8 @@ require('source-map-support').install();
 import * as chai from 'chai';
 import chaiAsPromised = require('chai-as-promised');
 import * as stream from 'stream';
+import * as os from 'os';
+import * as path from 'path';
 import * as bunyan from 'bunyan';
 import * as dbgmits from '../lib/index';
 import { startDebugSession, getLocalTargetExe } from './test_utils';
@@ -372,6 +374,78 @@ describe("Debug Session", () => {
       );
     });
   });
+
+  describe("Transcripts", () => {
+    const transcriptText =
+      '0.500 < =thread-group-added,id="i1"\n' +
+      '1.000 > -stack-info-depth\n' +
+      '2.000 > -stack-info-depth 1\n' +
+      '3.000 < ^done,depth="3"\n' +
+      '3.500 < =thread-created,id="1",group-id="i1"\n' +
+      '4.000 < ^done,depth="1"\n' +
+      '5.000 > -gdb-exit\n' +
+      '6.000 < ^exit\n';
+
+    it("parses a transcript", () => {
+      const transcript = dbgmits.parseTranscript(transcriptText);
+      expect(transcript.length).to.equal(8);
+      expect(transcript[1]).to.have.property('time', 1);
+      expect(transcript[1]).to.have.property('direction', dbgmits.TranscriptDirection.ToDebugger);
+      expect(transcript[1]).to.have.property('text', '-stack-info-depth');
+      expect(transcript[3]).to.have.property('direction', dbgmits.TranscriptDirection.FromDebugger);
+    });
+
+    it("plays back a transcript recorded with pipelined commands", () => {
+      const replaySession = new dbgmits.ReplayDebugSession(dbgmits.parseTranscript(transcriptText));
+      let threadCreated = false;
+      replaySession.once(dbgmits.EVENT_THREAD_CREATED, () => { threadCreated = true; });
+      // the commands were pipelined during the recording but are issued one by one here
+      return replaySession.getStackDepth()
+      .then((depth: number) => {
+        expect(depth).to.equal(3);
+        return replaySession.getStackDepth({ maxDepth: 1 });
+      })
+      .then((depth: number) => {
+        expect(depth).to.equal(1);
+        expect(threadCreated).to.be.true;
+        return replaySession.end();
+      });
+    });
+
+    it("replays all the commands in a transcript in real time", () => {
+      const replaySession = new dbgmits.ReplayDebugSession(
+        dbgmits.parseTranscript(transcriptText), { realTime: true }
+      );
+      let threadCount = 0;
+      replaySession.on(dbgmits.EVENT_THREAD_CREATED, () => { ++threadCount; });
+      return replaySession.replay()
+      .then(() => {
+        expect(threadCount).to.equal(1);
+        return replaySession.end();
+      });
+    });
+
+    it("records a transcript of a live session", () => {
+      const transcriptFilename = path.join(os.tmpdir(), 'dbgmits_transcript_test.txt');
+      const debugSession = startDebugSession();
+      debugSession.startRecording(transcriptFilename);
+      return debugSession.setExecutableFile(localTargetExe)
+      .then(() => debugSession.end())
+      .then(() => dbgmits.loadTranscript(transcriptFilename))
+      .then((transcript: dbgmits.ITranscriptEntry[]) => {
+        const commands = transcript.filter((entry: dbgmits.ITranscriptEntry) => {
+          return entry.direction === dbgmits.TranscriptDirection.ToDebugger;
+        });
+        expect(commands.length).to.equal(2);
+        expect(commands[0].text).to.match(/^-file-exec-and-symbols/);
+        expect(commands[1].text).to.equal('-gdb-exit');
+        // the replayed session should be able to do exactly what the live one did
+        const replaySession = new dbgmits.ReplayDebugSession(transcript);
+        return replaySession.setExecutableFile(localTargetExe)
+        .then(() => replaySession.end());
+      });
+    });
+  });
 /*
   describe("Remote Debugging Setup", () => {
     var debugSession: DebugSession;
@@ -0,0 +1,434 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+require('source-map-support').install();
+
+import * as chai from 'chai';
+import chaiAsPromised = require('chai-as-promised');
+import * as bunyan from 'bunyan';
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import * as dbgmits from '../lib/index';
+import {
+  beforeEachTestWithLogger, logSuite as log, startFakeDebugSession, IFakeDebuggerConfig,
+  startDebugSession, getLocalTargetExe, runToFunc, runToFuncAndStepOut
+} from './test_utils';
+
+chai.use(chaiAsPromised);
+
+// aliases
+var expect = chai.expect;
+import DebugSession = dbgmits.DebugSession;
+
+/**
+ * Measures how long it takes for the promise returned by the given function to be resolved,
+ * and prints out the result.
+ *
+ * @param label Description of what's being measured.
+ * @param fn Function that performs the operation to be measured.
+ * @return A promise that will be resolved with the elapsed time in milliseconds.
+ */
+function measure(label: string, fn: () => Promise<any>): Promise<number> {
+  const start = process.hrtime();
+  return fn()
+  .then(() => {
+    const elapsed = process.hrtime(start);
+    const elapsedMs = (elapsed[0] * 1e3) + (elapsed[1] / 1e6);
+    console.log(`      ${label}: ${elapsedMs.toFixed(1)} ms`);
+    return elapsedMs;
+  });
+}
+
+// Benchmarks are run against the fake debugger (see test/fake_debugger.cpp) so the results
+// reflect the overhead of the MI driver rather than the performance of a real debugger.
+// Use `npm run benchmarks` to run them.
+log(describe("Benchmarks @benchmark", function () {
+  this.timeout(600000);
+
+  var logger: bunyan.Logger;
+  var sessions: DebugSession[];
+
+  function startSession(config: IFakeDebuggerConfig): DebugSession {
+    // the logger would skew the results, so only pass it through to the first session
+    const debugSession = startFakeDebugSession(config, sessions.length ? undefined : logger);
+    sessions.push(debugSession);
+    return debugSession;
+  }
+
+  beforeEachTestWithLogger((testLogger: bunyan.Logger) => {
+    logger = testLogger;
+    sessions = [];
+  });
+
+  afterEach(() => {
+    return Promise.all(sessions.map((debugSession: DebugSession) => debugSession.end()));
+  });
+
+  it("restores 1000 breakpoints", () => {
+    const numBreakpoints = 1000;
+    const originalSession = startSession({});
+    const restoredSession = startSession({});
+    let state: dbgmits.ISessionState;
+    return measure(`add ${numBreakpoints} breakpoints one at a time`, () => {
+      let done = Promise.resolve<any>(null);
+      for (let i = 0; i < numBreakpoints; ++i) {
+        done = done.then(() => originalSession.addBreakpoint(`func${i}`, { condition: `i==${i}` }));
+      }
+      return done;
+    })
+    .then(() => {
+      state = originalSession.exportState();
+      expect(state.breakpoints).to.have.length(numBreakpoints);
+      return measure(`import ${numBreakpoints} breakpoints`, () => restoredSession.importState(state));
+    })
+    .then(() => {
+      expect(restoredSession.exportState()).to.deep.equal(state);
+    });
+  });
+
+  it("creates watches", () => {
+    const debugSession = startSession({});
+    let done = Promise.resolve();
+    [10, 50, 100, 200].forEach((numWatches: number) => {
+      const watches: dbgmits.IWatchSpec[] = [];
+      for (let i = 0; i < numWatches; ++i) {
+        watches.push({ expression: `local${i}` });
+      }
+      done = done
+      .then(() => measure(`add ${numWatches} watches one at a time`, () => {
+        let added = Promise.resolve<any>(null);
+        watches.forEach((watch: dbgmits.IWatchSpec) => {
+          added = added.then(() => debugSession.addWatch(watch.expression));
+        });
+        return added;
+      }))
+      .then(() => measure(`add ${numWatches} watches in one batch`, () => {
+        return debugSession.addWatches(watches);
+      }))
+      .then(() => {});
+    });
+    return done;
+  });
+
+  it("updates thousands of watches with and without freezing", () => {
+    const numWatches = 5000;
+    const numChanging = 100;
+    // only the first few watches change on each stop
+    const debugSession = startSession({ changes: numChanging });
+    const policy = new dbgmits.WatchFreezePolicy(debugSession, { maxUnchangedUpdates: 3 });
+    const watches: dbgmits.IWatchSpec[] = [];
+    for (let i = 0; i < numWatches; ++i) {
+      watches.push({ expression: `local${i}` });
+    }
+    return debugSession.addWatches(watches)
+    .then(() => measure(`update ${numWatches} watches`, () => debugSession.updateWatch('*')))
+    .then(() => {
+      let done = Promise.resolve<any>(null);
+      for (let i = 0; i < 3; ++i) {
+        done = done.then(() => policy.update());
+      }
+      return done;
+    })
+    .then(() => {
+      const numFrozen = debugSession.watchTree.roots.filter(
+        (watch: dbgmits.IWatchTreeNode) => watch.isFrozen
+      ).length;
+      expect(numFrozen).to.equal(numWatches - numChanging);
+      return measure(
+        `update ${numWatches} watches with ${numFrozen} frozen`, () => debugSession.updateWatch('*')
+      );
+    });
+  });
+
+  it("retrieves a very deep stack one page at a time", () => {
+    const numFrames = 100000;
+    const debugSession = startSession({ frames: numFrames });
+    return measure(`retrieve ${numFrames} frames at once`, () => debugSession.getStackFrames())
+    .then(() => measure(`retrieve ${numFrames} frames in pages of 1000`, () => {
+      let numRetrieved = 0;
+      return debugSession.iterateStackFrames({ pageSize: 1000 })
+      .forEach((frames: dbgmits.IStackFrameInfo[]) => { numRetrieved += frames.length; })
+      .then(() => expect(numRetrieved).to.equal(numFrames));
+    }))
+    .then(() => measure(`retrieve the innermost 1000 of ${numFrames} frames`, () => {
+      return debugSession.iterateStackFrames({ pageSize: 1000, maxDepth: 1000 }).next();
+    }));
+  });
+
+  it("retains hundreds of thousands of frames with and without interning", () => {
+    const numFrames = 1000;
+    const numStacks = 200;
+    const debugSession = startSession({ frames: numFrames });
+    // the heap usage is only meaningful if garbage can be collected before it's measured, which
+    // requires node to be run with --expose-gc (as is done by `npm run benchmarks`)
+    const gc: () => void = (<any> global).gc;
+    if (!gc) {
+      console.log('      run node with --expose-gc for accurate heap usage figures');
+    }
+    const getHeapUsed = () => {
+      if (gc) {
+        gc();
+      }
+      return process.memoryUsage().heapUsed;
+    };
+    const retainStacks = (label: string) => {
+      const stacks: dbgmits.IStackFrameInfo[][] = [];
+      const heapUsedBefore = getHeapUsed();
+      let done = Promise.resolve<any>(null);
+      for (let i = 0; i < numStacks; ++i) {
+        done = done
+        .then(() => debugSession.getStackFrames())
+        .then((frames: dbgmits.IStackFrameInfo[]) => { stacks.push(frames); });
+      }
+      return done.then(() => {
+        const heapUsedMB = (getHeapUsed() - heapUsedBefore) / (1024 * 1024);
+        console.log(`      ${label}: ${heapUsedMB.toFixed(1)} MB`);
+        const lastFrame = stacks[numStacks - 1][numFrames - 1];
+        expect(lastFrame).to.have.property('func', `fakeFunc${numFrames - 1}`);
+        return heapUsedMB;
+      });
+    };
+    let plainHeapUsedMB: number;
+    return retainStacks(`heap used by ${numFrames * numStacks} frames`)
+    .then((heapUsedMB: number) => {
+      plainHeapUsedMB = heapUsedMB;
+      debugSession.internFrameStrings = true;
+      return retainStacks(`heap used by ${numFrames * numStacks} interned frames`);
+    })
+    .then((heapUsedMB: number) => {
+      if (gc) {
+        expect(heapUsedMB).to.be.lessThan(plainHeapUsedMB);
+      }
+    });
+  });
+
+  it("retrieves the stack after every step with and without the backtrace cache", () => {
+    const numFrames = 200;
+    const numSteps = 100;
+    const debugSession = startSession({ frames: numFrames });
+    const stepAndRetrieveFrames = (retrieveFrames: () => Promise<any>) => {
+      let done = Promise.resolve<any>(null);
+      for (let i = 0; i < numSteps; ++i) {
+        done = done
+        .then(() => new Promise<void>((resolve) => {
+          debugSession.once(dbgmits.EVENT_STEP_FINISHED, () => resolve());
+          debugSession.stepOverLine({ threadId: 1 });
+        }))
+        .then(retrieveFrames);
+      }
+      return done;
+    };
+    return debugSession.startInferior()
+    .then(() => measure(`${numSteps} steps, retrieving all ${numFrames} frames`, () => {
+      return stepAndRetrieveFrames(() => debugSession.getStackFrames({ threadId: 1 }));
+    }))
+    .then(() => measure(`${numSteps} steps, reusing cached frames`, () => {
+      return stepAndRetrieveFrames(() => debugSession.getCachedStackFrames(1));
+    }))
+    .then(() => {
+      const stats = debugSession.backtraceCacheStats;
+      console.log(
+        `      ${stats.framesRetrieved} frames retrieved, ${stats.framesReused} frames reused`
+      );
+      expect(stats.framesRetrieved).to.be.lessThan(numFrames * 2);
+    });
+  });
+
+  // Unlike the rest of the benchmarks these are run against GDB, since the fake debugger can't
+  // load the Python helper.
+  describe("Python helper", () => {
+    function compareSnapshots(
+      debugSession: DebugSession, targetName: string, funcName: string, args?: string
+    ): Promise<any> {
+      sessions.push(debugSession);
+      const options = {
+        detail: dbgmits.VariableDetailLevel.All,
+        includeLocals: true,
+        includeRegisters: true
+      };
+      return debugSession.setExecutableFile(getLocalTargetExe(targetName))
+      .then(() => args ? debugSession.setInferiorArguments(args) : undefined)
+      .then(() => runToFunc(debugSession, funcName, () => {
+        return measure(
+          `${targetName} snapshot via MI`, () => debugSession.getProcessSnapshot(options)
+        )
+        .then(() => debugSession.loadPythonHelper())
+        .then((isLoaded: boolean) => {
+          if (!isLoaded) {
+            console.log('      Python helper is not supported by the debugger');
+            return;
+          }
+          return measure(
+            `${targetName} snapshot via Python helper`,
+            () => debugSession.getProcessSnapshot(options)
+          );
+        });
+      }));
+    }
+
+    it("captures a snapshot of stack_tests_target", () => {
+      return compareSnapshots(startDebugSession(), 'stack_tests_target', 'funcWithOneSimpleArg');
+    });
+
+    it("captures a snapshot of thread_tests_target with 64 threads", () => {
+      return compareSnapshots(
+        startDebugSession(), 'thread_tests_target', 'funcA', '--threads 64'
+      );
+    });
+  });
+
+  // Run against GDB to measure the throughput of the whole path, including the debugger.
+  it("reads 16 MB of memory as hex strings and into buffers", () => {
+    const debugSession = startDebugSession();
+    sessions.push(debugSession);
+    const numBytes = 16 * 1024 * 1024;
+    const measureThroughput = (label: string, read: () => Promise<any>) => {
+      return measure(label, read)
+      .then((elapsedMs: number) => {
+        const throughput = (numBytes / (1024 * 1024)) / (elapsedMs / 1000);
+        console.log(`      ${label}: ${throughput.toFixed(1)} MB/s`);
+      });
+    };
+    return debugSession.setExecutableFile(getLocalTargetExe('data_tests_target'))
+    .then(() => runToFuncAndStepOut(debugSession, 'memoryAccessBreakpoint', () => {
+      return measureThroughput('read as a hex string and decode', () => {
+        return debugSession.readMemory('&largeArray', numBytes)
+        .then((blocks: dbgmits.IMemoryBlock[]) => {
+          expect(Buffer.from(blocks[0].contents, 'hex').length).to.equal(numBytes);
+        });
+      })
+      .then(() => measureThroughput('read into buffers', () => {
+        return debugSession.readMemoryBuffer('&largeArray', numBytes)
+        .then((blocks: dbgmits.IMemoryBuffer[]) => {
+          expect(blocks[0].contents.length).to.equal(numBytes);
+        });
+      }));
+    }));
+  });
+
+  it("reads overlapping ranges of memory with and without the page cache", () => {
+    const debugSession = startSession({});
+    // follow a chain of small reads around a handful of addresses, like a memory view would
+    const readAll = () => {
+      let reads = Promise.resolve();
+      for (let i = 0; i < 5000; ++i) {
+        const address = '0x' + (0x10000 + ((i % 16) * 0x400) + (i % 7) * 8).toString(16);
+        reads = reads.then(() => debugSession.readMemory(address, 64).then(() => undefined));
+      }
+      return reads;
+    };
+    // memory is only cached while the target is stopped
+    return runToFunc(debugSession, 'main', () => {
+      return measure('without the cache', readAll)
+      .then(() => {
+        debugSession.cacheMemoryReads = true;
+        return measure('with the cache', readAll);
+      })
+      .then(() => {
+        const stats = debugSession.memoryCacheStats;
+        console.log(`      hit rate: ${(stats.hitRate * 100).toFixed(1)}%`);
+        expect(stats.misses).to.be.lessThan(stats.hits);
+      });
+    });
+  });
+
+  it("dumps 256 MB of memory with gaps to a file, then stops and resumes the dump", () => {
+    // every 8th page can't be read
+    const debugSession = startSession({ unreadable: 8 });
+    const numBytes = 256 * 1024 * 1024;
+    const filename = path.join(os.tmpdir(), `dbgmits-memory-dump-${process.pid}.bin`);
+    const report = (label: string, result: dbgmits.IMemoryReadResult) => {
+      const throughput = result.bytesPerSecond / (1024 * 1024);
+      console.log(`      ${label}: ${throughput.toFixed(1)} MB/s, ${result.gaps.length} gaps`);
+    };
+    let reader = new dbgmits.MemoryRangeReader(debugSession, '0x0', numBytes);
+    return reader.readToFile(filename)
+    .then((result: dbgmits.IMemoryReadResult) => {
+      report('dump', result);
+      expect(result.isComplete).to.be.true;
+      expect(result.bytesRead + result.bytesUnreadable).to.equal(numBytes);
+      expect(fs.statSync(filename).size).to.equal(numBytes);
+      reader = new dbgmits.MemoryRangeReader(debugSession, '0x0', numBytes, {
+        onProgress: (progress: dbgmits.IMemoryReadProgress) => {
+          if (progress.nextOffset >= (numBytes / 2)) {
+            reader.stop();
+          }
+        }
+      });
+      return reader.readToFile(filename);
+    })
+    .then((result: dbgmits.IMemoryReadResult) => {
+      expect(result.isComplete).to.be.false;
+      expect(fs.statSync(filename).size).to.equal(result.nextOffset);
+      reader = new dbgmits.MemoryRangeReader(debugSession, '0x0', numBytes);
+      return reader.readToFile(filename, { resume: true });
+    })
+    .then((result: dbgmits.IMemoryReadResult) => {
+      report('resumed dump', result);
+      expect(result.isComplete).to.be.true;
+      expect(fs.statSync(filename).size).to.equal(numBytes);
+    })
+    .then(() => fs.unlinkSync(filename), (err: Error) => {
+      fs.unlinkSync(filename);
+      throw err;
+    });
+  });
+
+  // Run against GDB because the fake debugger generates frames much faster than GDB unwinds them.
+  it("retrieves a very deep stack of a real target one page at a time", () => {
+    const recursionDepth = 10000;
+    const debugSession = startDebugSession();
+    sessions.push(debugSession);
+    return debugSession.setExecutableFile(getLocalTargetExe('stack_tests_target'))
+    .then(() => debugSession.setInferiorArguments(`--recursion-depth ${recursionDepth}`))
+    .then(() => runToFunc(debugSession, 'funcAtBottomOfDeepRecursion', () => {
+      let numFrames = 0;
+      return debugSession.getStackDepth()
+      .then((depth: number) => {
+        // the recursion is topped by funcAtBottomOfDeepRecursion() and followed by main()
+        expect(depth).to.be.at.least(recursionDepth);
+        numFrames = depth;
+        return measure(`retrieve ${numFrames} frames at once`, () => debugSession.getStackFrames());
+      })
+      .then(() => measure(`retrieve ${numFrames} frames in pages of 1000`, () => {
+        let numRetrieved = 0;
+        return debugSession.iterateStackFrames({ pageSize: 1000 })
+        .forEach((frames: dbgmits.IStackFrameInfo[]) => { numRetrieved += frames.length; })
+        .then(() => expect(numRetrieved).to.equal(numFrames));
+      }))
+      .then(() => measure(`retrieve the innermost 1000 of ${numFrames} frames`, () => {
+        return debugSession.iterateStackFrames({ pageSize: 1000, maxDepth: 1000 }).next();
+      }));
+    }));
+  });
+
+  // Run against GDB because the cost of each round trip to the fake debugger is negligible.
+  it("retrieves the stacks of 2000 threads one at a time and all at once", () => {
+    const debugSession = startDebugSession();
+    sessions.push(debugSession);
+    return debugSession.setExecutableFile(getLocalTargetExe('thread_tests_target'))
+    .then(() => debugSession.setInferiorArguments('--threads 2000'))
+    .then(() => runToFunc(debugSession, 'funcA', () => {
+      let numThreads = 0;
+      return measure('retrieve stacks one thread at a time', () => {
+        return debugSession.getThreads()
+        .then((info: dbgmits.IMultiThreadInfo) => {
+          numThreads = info.all.length;
+          let done = Promise.resolve<any>(null);
+          info.all.forEach((thread: dbgmits.IThreadInfo) => {
+            done = done.then(() => debugSession.getStackFrames({ threadId: thread.id }));
+          });
+          return done;
+        });
+      })
+      .then(() => {
+        // the target holds all its threads at a barrier until they've all been created
+        expect(numThreads).to.equal(2000);
+      })
+      .then(() => measure(`retrieve stacks of ${numThreads} threads all at once`, () => {
+        return debugSession.getAllThreadStacks();
+      }));
+    }));
+  });
+}));
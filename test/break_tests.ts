@@ -180,6 +180,77 @@ log(describe("Debug Session", () => {
       });
     });
 
+    describe("#exportState() / #importState()", () => {
+      it("exports breakpoints along with their current options", () => {
+        return debugSession.addBreakpoint('main')
+        .then(() => debugSession.addBreakpoint('funcC', { condition: '1', ignoreCount: 2 }))
+        .then((info: dbgmits.IBreakpointInfo) => debugSession.disableBreakpoint(info.id))
+        .then(() => debugSession.addBreakpoint('funcA', { isTemp: true }))
+        .then(() => {
+          const state = debugSession.exportState();
+          expect(state.breakpoints).to.have.length(2);
+          expect(state.breakpoints[0]).to.have.property('location', 'main');
+          expect(state.breakpoints[1]).to.have.property('location', 'funcC');
+          expect(state.breakpoints[1].options).to.have.property('condition', '1');
+          expect(state.breakpoints[1].options).to.have.property('ignoreCount', 2);
+          expect(state.breakpoints[1].options).to.have.property('isDisabled', true);
+        });
+      });
+
+      it("doesn't export removed breakpoints", () => {
+        return debugSession.addBreakpoint('main')
+        .then((info: dbgmits.IBreakpointInfo) => debugSession.removeBreakpoint(info.id))
+        .then(() => {
+          expect(debugSession.exportState().breakpoints).to.be.empty;
+        });
+      });
+
+      it("restores exported breakpoints in another session", () => {
+        let state: dbgmits.ISessionState;
+        return debugSession.addBreakpoint('main')
+        .then(() => debugSession.addBreakpoint('funcC', { isDisabled: true }))
+        .then(() => debugSession.addBreakpoint('noSuchFunc', { isPending: true }))
+        .then(() => {
+          // make sure the state survives a round trip through JSON
+          state = JSON.parse(JSON.stringify(debugSession.exportState()));
+          return debugSession.end();
+        })
+        .then(() => {
+          debugSession = startDebugSession();
+          return debugSession.setExecutableFile(localTargetExe);
+        })
+        .then(() => debugSession.importState(state))
+        .then((result: dbgmits.ISessionStateImportResult) => {
+          expect(result.failedBreakpoints).to.be.empty;
+          expect(result.breakpoints).to.have.length(3);
+          expect(result.breakpoints[0].locations[0].func).to.match(/^main/);
+          expect(result.breakpoints[1]).to.have.property('isEnabled', false);
+          expect(result.breakpoints[1]).to.have.property('locations').of.length(3);
+          expect(result.breakpoints[2]).to.have.property('pending', 'noSuchFunc');
+          expect(JSON.parse(JSON.stringify(debugSession.exportState()))).to.deep.equal(state);
+        });
+      });
+
+      it("reports breakpoints that couldn't be restored", () => {
+        const state: dbgmits.ISessionState = {
+          breakpoints: [
+            { location: 'main', options: {} },
+            { location: 'noSuchFunc', options: {} }
+          ],
+          watches: []
+        };
+        return debugSession.importState(state)
+        .then((result: dbgmits.ISessionStateImportResult) => {
+          expect(result.breakpoints).to.have.length(2);
+          expect(result.breakpoints[0]).to.have.property('id');
+          expect(result.breakpoints[1]).to.be.null;
+          expect(result.failedBreakpoints).to.have.length(1);
+          expect(result.failedBreakpoints[0].state).to.equal(state.breakpoints[1]);
+          expect(result.failedBreakpoints[0].error).to.be.instanceof(dbgmits.CommandFailedError);
+        });
+      });
+    }); // describe #exportState() / #importState()
+
     describe("Events", () => {
       it("Emits EVENT_BREAKPOINT_MODIFIED when breakpoint hit count changes", () => {
         const checkBreakpointHitCount = new Promise<void>((resolve, reject) => {
@@ -6,6 +6,7 @@ require('source-map-support').install();
 import * as chai from 'chai';
 import chaiAsPromised = require('chai-as-promised');
 import * as bunyan from 'bunyan';
+import * as stream from 'stream';
 import * as dbgmits from '../lib/index';
 import {
   beforeEachTestWithLogger, logSuite as log, startDebugSession,
@@ -62,6 +63,31 @@ log(describe("Debug Session", () => {
       });
     });
 
+    it("#evaluateExpressions", () => {
+      return runToFuncAndStepOut(debugSession, 'expressionEvaluationBreakpoint', () => {
+        return debugSession.evaluateExpressions([
+          { expression: 'a', isSideEffectFree: true },
+          { expression: 'noSuchVariable', isSideEffectFree: true },
+          { expression: 'get10()' },
+          { expression: 'a + b', isSideEffectFree: true }
+        ])
+        .then((results: dbgmits.IExpressionResult[]) => {
+          expect(results).to.have.length(4);
+          expect(results[0]).to.deep.equal({ value: '1', error: null });
+          expect(results[1].value).to.be.null;
+          expect(results[1].error).to.be.instanceof(dbgmits.CommandFailedError);
+          expect(results[2]).to.deep.equal({ value: '10', error: null });
+          expect(results[3]).to.deep.equal({ value: '3', error: null });
+          return debugSession.evaluateExpressions(
+            [{ expression: 'a + b', isSideEffectFree: true }], { threadId: 1, frameLevel: 0 }
+          );
+        })
+        .then((results: dbgmits.IExpressionResult[]) => {
+          expect(results).to.deep.equal([{ value: '3', error: null }]);
+        });
+      });
+    });
+
     describe("#readMemory", () => {
       it("reads memory at an address specified as a hex literal", () => {
         return runToFuncAndStepOut(debugSession, 'memoryAccessBreakpoint', () => {
@@ -102,6 +128,107 @@ log(describe("Debug Session", () => {
           });
         });
       });
+
+      it("reads memory and parses the addresses of the blocks", () => {
+        debugSession.numericAddresses = true;
+        return runToFuncAndStepOut(debugSession, 'memoryAccessBreakpoint', () => {
+          return debugSession.readMemory('&array', 2)
+          .then((blocks: dbgmits.IMemoryBlock[]) => {
+            expect(blocks.length).to.equal(1);
+            expect(blocks[0].numericBegin.toNumber()).to.equal(parseInt(blocks[0].begin, 16));
+            expect(blocks[0].numericOffset).to.equal(0);
+            expect(dbgmits.getRangeLength({
+              begin: blocks[0].numericBegin, end: blocks[0].numericEnd
+            })).to.equal(2);
+          });
+        });
+      });
+    });
+
+    describe("#readMemoryBuffer", () => {
+      it("reads memory into a buffer", () => {
+        return runToFuncAndStepOut(debugSession, 'memoryAccessBreakpoint', () => {
+          return debugSession.readMemoryBuffer('&array', 4)
+          .then((blocks: dbgmits.IMemoryBuffer[]) => {
+            expect(blocks.length).to.equal(1);
+            expect(blocks[0].offset).to.equal(0);
+            expect(blocks[0].contents).to.deep.equal(Buffer.from([1, 2, 3, 4]));
+          });
+        });
+      });
+
+      it("reads memory in chunks and joins them into one buffer", () => {
+        return runToFuncAndStepOut(debugSession, 'memoryAccessBreakpoint', () => {
+          const options = { byteOffset: 10, chunkSize: 64 };
+          return debugSession.readMemoryBuffer('&largeArray', 1000, options)
+          .then((blocks: dbgmits.IMemoryBuffer[]) => {
+            expect(blocks.length).to.equal(1);
+            expect(blocks[0].contents.length).to.equal(1000);
+            for (let i = 0; i < 1000; ++i) {
+              expect(blocks[0].contents[i]).to.equal((i + 10) % 256);
+            }
+          });
+        });
+      });
+    });
+
+    it("caches memory reads until memory is written", () => {
+      return runToFuncAndStepOut(debugSession, 'memoryAccessBreakpoint', () => {
+        let arrayAddress: string;
+        // only reads from literal addresses are cached
+        return debugSession.readMemory('&array', 4)
+        .then((blocks: dbgmits.IMemoryBlock[]) => {
+          arrayAddress = blocks[0].begin;
+          debugSession.cacheMemoryReads = true;
+          return debugSession.readMemory(arrayAddress, 4);
+        })
+        .then((blocks: dbgmits.IMemoryBlock[]) => {
+          expect(blocks.length).to.equal(1);
+          expect(blocks[0].begin).to.equal(arrayAddress);
+          expect(blocks[0].contents).to.equal('01020304');
+          return debugSession.readMemory(arrayAddress, 2, { byteOffset: 1 });
+        })
+        .then((blocks: dbgmits.IMemoryBlock[]) => {
+          expect(blocks[0].offset).to.match(/^0x0+$/);
+          expect(blocks[0].contents).to.equal('0203');
+          expect(debugSession.memoryCacheStats).to.have.property('hits', 1);
+          expect(debugSession.memoryCacheStats).to.have.property('misses', 1);
+          return debugSession.writeMemory(arrayAddress, Buffer.from([5]));
+        })
+        .then(() => debugSession.readMemory(arrayAddress, 4))
+        .then((blocks: dbgmits.IMemoryBlock[]) => {
+          expect(blocks[0].contents).to.equal('05020304');
+          expect(debugSession.memoryCacheStats).to.have.property('misses', 2);
+          expect(debugSession.memoryCacheStats).to.have.property('invalidations', 1);
+        });
+      });
+    });
+
+    it("reads a large range of memory into a stream with a MemoryRangeReader", () => {
+      return runToFuncAndStepOut(debugSession, 'memoryAccessBreakpoint', () => {
+        const numBytes = 1024 * 1024;
+        const chunks: Buffer[] = [];
+        const outStream = new stream.Writable({
+          write: (chunk: Buffer, encoding: string, callback: Function) => {
+            chunks.push(chunk);
+            callback();
+          }
+        });
+        const reader = new dbgmits.MemoryRangeReader(
+          debugSession, '&largeArray', numBytes, { blockSize: 64 * 1024, startOffset: 5 }
+        );
+        return reader.readToStream(outStream)
+        .then((result: dbgmits.IMemoryReadResult) => {
+          expect(result.isComplete).to.be.true;
+          expect(result.gaps).to.be.empty;
+          expect(result.bytesRead).to.equal(numBytes - 5);
+          expect(result.nextOffset).to.equal(numBytes);
+          const contents = Buffer.concat(chunks);
+          expect(contents.length).to.equal(numBytes - 5);
+          const mismatch = contents.findIndex((byte: number, i: number) => byte !== ((i + 5) % 256));
+          expect(mismatch).to.equal(-1);
+        });
+      });
     });
 
     it("#getRegisterNames", () => {
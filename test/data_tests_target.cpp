@@ -29,6 +29,9 @@ void expressionEvaluation()
     return;
 }
 
+// big enough to benchmark memory reads
+unsigned char largeArray[16 * 1024 * 1024];
+
 void memoryAccessBreakpoint()
 {
 }
@@ -36,6 +39,10 @@ void memoryAccessBreakpoint()
 void memoryAccess()
 {
     char array[] = { 0x01, 0x02, 0x03, 0x04 };
+    for (unsigned int i = 0; i < sizeof(largeArray); ++i)
+    {
+        largeArray[i] = (unsigned char)i;
+    }
     
     memoryAccessBreakpoint();
     return;
@@ -11,6 +11,8 @@ import {
   beforeEachTestWithLogger, logSuite as log, startDebugSession, runToFuncAndStepOut,
   SourceLineResolver, getLocalTargetExe
 } from './test_utils';
+import { spawn, ChildProcess } from 'child_process';
+import * as fs from 'fs';
 
 chai.use(chaiAsPromised);
 
@@ -228,5 +230,81 @@ log(describe("Debug Session", () => {
         });
       });
     });
+
+    describe("SamplingProfiler @skipOnLLDB", () => {
+      it("samples the stacks of a running process", () => {
+        const profiler = new dbgmits.SamplingProfiler(debugSession, { rate: 20 });
+        return debugSession.setAsyncExecution(true)
+        .then(() => debugSession.setInferiorArguments('--spin 3'))
+        .then(() => debugSession.startInferior())
+        .then(() => {
+          profiler.start();
+          return new Promise<void>((resolve) => setTimeout(resolve, 1000));
+        })
+        .then(() => profiler.stop())
+        .then((profile: dbgmits.Profile) => {
+          expect(profile.sampleCount).to.be.above(0);
+          expect(profile.pauseTimes).to.have.length(profile.sampleCount);
+          expect(profile.maxPauseMs).to.be.above(0);
+          // the target should spend most of its time running rather than being sampled
+          expect(profile.meanPauseMs * profile.sampleCount).to.be.below(profile.durationMs * 0.2);
+          expect(profile.toFoldedStacks()).to.match(/^main;spinFor\b/m);
+          const tree = profile.getCallTree();
+          expect(tree.totalCount).to.be.at.least(profile.sampleCount);
+          expect(tree.children[0]).to.have.property('name', 'main');
+          expect(profile.toPprof().length).to.be.above(0);
+        });
+      });
+    });
+
+    describe("#attachToProcess() @skipOnLLDB", () => {
+      let targetProcess: ChildProcess;
+
+      beforeEach(function () {
+        // the debugger can't attach to processes it didn't start if ptrace is restricted
+        try {
+          if (fs.readFileSync('/proc/sys/kernel/yama/ptrace_scope', 'utf8').trim() !== '0') {
+            this.skip();
+          }
+        } catch (err) {
+          // no Yama, no restrictions
+        }
+        targetProcess = spawn(localTargetExe, ['--wait-for-input']);
+      });
+
+      afterEach(() => {
+        targetProcess.kill();
+      });
+
+      it("attaches to a running process and then detaches from it", () => {
+        return debugSession.attachToProcess(targetProcess.pid)
+        .then((info: dbgmits.IAttachInfo) => {
+          expect(info).to.have.property('pid', targetProcess.pid);
+          expect(info).to.have.property('threadGroup');
+          expect(info.attachTime).to.be.above(0);
+          return debugSession.getThreads();
+        })
+        .then((threads: dbgmits.IMultiThreadInfo) => {
+          expect(threads.all).to.have.length(1);
+          return debugSession.detach();
+        })
+        .then((info: dbgmits.IDetachInfo) => {
+          expect(info.stoppedTime).to.be.above(0);
+        });
+      });
+
+      it("attaches to a running process without stopping it", () => {
+        return debugSession.attachToProcess(targetProcess.pid, { skipSymbols: true, nonStop: true })
+        .then(() => debugSession.getThreads())
+        .then((threads: dbgmits.IMultiThreadInfo) => {
+          expect(threads.all).to.have.length(1);
+          expect(threads.all[0]).to.have.property('isStopped', false);
+          return debugSession.detach();
+        })
+        .then((info: dbgmits.IDetachInfo) => {
+          expect(info.stoppedTime).to.equal(0);
+        });
+      });
+    });
   });
 }));
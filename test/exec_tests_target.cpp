@@ -1,4 +1,7 @@
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 
 int getNextInt()
 {
@@ -12,8 +15,33 @@ void printNextInt()
     printf("%d\n", nextInt);
 }
 
+volatile unsigned spinCounter = 0;
+
+void spinFor(time_t seconds)
+{
+    // keeps the process busy so there's something to profile
+    time_t endTime = time(NULL) + seconds;
+    while (time(NULL) < endTime)
+    {
+        for (int i = 0; i < 100000; ++i)
+        {
+            ++spinCounter;
+        }
+    }
+}
+
 int main(int argc, const char *argv[])
 {
+    // tests that attach to a running process need it to stick around for a while
+    if ((argc == 2) && (strcmp(argv[1], "--wait-for-input") == 0))
+    {
+        getchar();
+    }
+    else if ((argc == 3) && (strcmp(argv[1], "--spin") == 0))
+    {
+        spinFor(atoi(argv[2]));
+    }
+
     for (int i = 0; i < 10; ++i)
 	{
 		printNextInt(); // bp: main::printNextInt()
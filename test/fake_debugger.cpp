@@ -0,0 +1,688 @@
+// A stand-in debugger that speaks just enough GDB/MI to drive a DebugSession, it doesn't
+// actually debug anything but it can generate load at rates a real debugger can't produce on
+// demand. It's launched like GDB (the command line arguments are ignored), and configured via
+// the following environment variables:
+//
+// FAKE_DEBUGGER_THREADS        Number of =thread-created notifications to emit when the
+//                              inferior is started (default 1).
+// FAKE_DEBUGGER_THREAD_RATE    Maximum number of =thread-created notifications to emit per
+//                              second, zero means as fast as possible (default 0).
+// FAKE_DEBUGGER_TARGET_OUTPUT  Number of @ target output records to emit every time the
+//                              inferior is resumed (default 0).
+// FAKE_DEBUGGER_FRAMES         Depth of the stack of every thread (default 3).
+// FAKE_DEBUGGER_CHILDREN       Number of children of every variable object created with
+//                              -var-create (default 0).
+// FAKE_DEBUGGER_LOCALS         Number of locals in every frame (default 2).
+// FAKE_DEBUGGER_CHANGES        Number of entries in every -var-update changelist, -1 means
+//                              every variable object changes on every stop (default -1).
+// FAKE_DEBUGGER_UNREADABLE     If non-zero every Nth 4 KB page of memory can't be read, e.g. 4
+//                              makes pages 0, 4, 8, ... unreadable (default 0).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Config
+{
+    int threads;
+    int threadRate;
+    int targetOutput;
+    int frames;
+    int children;
+    int locals;
+    int changes;
+    int unreadable;
+};
+
+static Config config;
+// identifiers of the threads that have been created so far
+static int threadCount = 0;
+static int nextVarId = 1;
+static int nextBreakpointId = 1;
+// incremented every time the inferior stops, used to make variable values change between stops
+static int stopCount = 0;
+static bool hasStarted = false;
+// names of the root variable objects that currently exist
+static std::set<std::string> rootVars;
+// names of the variable objects that are currently frozen
+static std::set<std::string> frozenVars;
+// MI output is accumulated here and written out in one go
+static std::string output;
+
+static int getConfigValue(const char* name, int defaultValue)
+{
+    const char* value = getenv(name);
+    return value ? atoi(value) : defaultValue;
+}
+
+static void flushOutput()
+{
+    fwrite(output.data(), 1, output.size(), stdout);
+    fflush(stdout);
+    output.clear();
+}
+
+// Splits a command line into arguments, double-quoted arguments may contain spaces.
+static std::vector<std::string> splitArgs(const std::string& line)
+{
+    std::vector<std::string> args;
+    std::string arg;
+    bool inQuotes = false;
+    bool hasArg = false;
+    for (size_t i = 0; i < line.size(); ++i)
+    {
+        char c = line[i];
+        if (inQuotes)
+        {
+            if ((c == '\\') && (i + 1 < line.size()))
+            {
+                arg += line[++i];
+            }
+            else if (c == '"')
+            {
+                inQuotes = false;
+            }
+            else
+            {
+                arg += c;
+            }
+        }
+        else if (c == '"')
+        {
+            inQuotes = true;
+            hasArg = true;
+        }
+        else if (c == ' ')
+        {
+            if (hasArg)
+            {
+                args.push_back(arg);
+                arg.clear();
+                hasArg = false;
+            }
+        }
+        else
+        {
+            arg += c;
+            hasArg = true;
+        }
+    }
+    if (hasArg)
+    {
+        args.push_back(arg);
+    }
+    return args;
+}
+
+// Strips the options (e.g. --thread N, --simple-values) from the arguments of a command, the
+// command name remains the first element.
+static std::vector<std::string> positionalArgs(const std::vector<std::string>& args)
+{
+    std::vector<std::string> result;
+    for (size_t i = 0; i < args.size(); ++i)
+    {
+        if ((args[i] == "--thread") || (args[i] == "--frame") || (args[i] == "--thread-group"))
+        {
+            ++i; // skip the value too
+        }
+        else if ((i == 0) || (args[i].compare(0, 2, "--") != 0))
+        {
+            result.push_back(args[i]);
+        }
+    }
+    return result;
+}
+
+static void appendFrame(int level, bool withLevel)
+{
+    char buf[256];
+    if (withLevel)
+    {
+        snprintf(buf, sizeof(buf), "level=\"%d\",", level);
+        output += buf;
+    }
+    snprintf(
+        buf, sizeof(buf),
+        "addr=\"0x%016x\",func=\"fakeFunc%d\",file=\"fake.cpp\",fullname=\"/fake/fake.cpp\",line=\"%d\"",
+        0x400000 + (level * 0x10), level, level + 1
+    );
+    output += buf;
+}
+
+static void appendResult(const std::string& token, const std::string& result)
+{
+    output += token;
+    output += result;
+    output += "\n(gdb) \n";
+}
+
+static void emitStopped(const char* reason)
+{
+    ++stopCount;
+    output += "*stopped,reason=\"";
+    output += reason;
+    output += "\",disp=\"keep\",bkptno=\"1\",frame={";
+    appendFrame(0, false);
+    output += ",args=[]},thread-id=\"1\",stopped-threads=\"all\"\n(gdb) \n";
+}
+
+static void runInferior()
+{
+    output += "*running,thread-id=\"all\"\n";
+    flushOutput();
+
+    if (!hasStarted)
+    {
+        hasStarted = true;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < config.threads; ++i)
+        {
+            char buf[128];
+            snprintf(buf, sizeof(buf), "=thread-created,id=\"%d\",group-id=\"i1\"\n", ++threadCount);
+            output += buf;
+            if (config.threadRate > 0)
+            {
+                flushOutput();
+                std::this_thread::sleep_until(
+                    start + std::chrono::microseconds((1000000LL * (i + 1)) / config.threadRate)
+                );
+            }
+        }
+    }
+
+    for (int i = 0; i < config.targetOutput; ++i)
+    {
+        char buf[128];
+        snprintf(buf, sizeof(buf), "@\"Target output line %d\\n\"\n", i);
+        output += buf;
+        // don't let the buffer grow without bound
+        if (output.size() > 65536)
+        {
+            flushOutput();
+        }
+    }
+}
+
+static void listFrames(const std::string& token, const std::vector<std::string>& args)
+{
+    int low = 0;
+    int high = config.frames - 1;
+    if (args.size() >= 3)
+    {
+        low = atoi(args[1].c_str());
+        high = atoi(args[2].c_str());
+    }
+    if (high >= config.frames)
+    {
+        high = config.frames - 1;
+    }
+    output += token;
+    output += "^done,stack=[";
+    for (int level = low; level <= high; ++level)
+    {
+        output += (level == low) ? "frame={" : ",frame={";
+        appendFrame(level, true);
+        output += "}";
+    }
+    output += "]\n(gdb) \n";
+}
+
+static void listArguments(const std::string& token, const std::vector<std::string>& args)
+{
+    int low = 0;
+    int high = config.frames - 1;
+    if (args.size() >= 4)
+    {
+        low = atoi(args[2].c_str());
+        high = atoi(args[3].c_str());
+    }
+    if (high >= config.frames)
+    {
+        high = config.frames - 1;
+    }
+    output += token;
+    output += "^done,stack-args=[";
+    for (int level = low; level <= high; ++level)
+    {
+        char buf[128];
+        snprintf(buf, sizeof(buf), "%sframe={level=\"%d\",args=[{name=\"arg\",value=\"%d\"}]}",
+                 (level == low) ? "" : ",", level, level);
+        output += buf;
+    }
+    output += "]\n(gdb) \n";
+}
+
+static void listVariables(const std::string& token)
+{
+    output += token;
+    output += "^done,variables=[{name=\"arg\",arg=\"1\",value=\"0\"}";
+    for (int i = 0; i < config.locals; ++i)
+    {
+        char buf[128];
+        snprintf(buf, sizeof(buf), ",{name=\"local%d\",type=\"int\",value=\"%d\"}", i, i + stopCount);
+        output += buf;
+    }
+    output += "]\n(gdb) \n";
+}
+
+static void listThreads(const std::string& token)
+{
+    int count = (threadCount > 0) ? threadCount : 1;
+    output += token;
+    output += "^done,threads=[";
+    for (int id = 1; id <= count; ++id)
+    {
+        char buf[128];
+        snprintf(buf, sizeof(buf), "%s{id=\"%d\",target-id=\"Thread 0x%x (LWP %d)\",frame={",
+                 (id == 1) ? "" : ",", id, id * 0x1000, 1000 + id);
+        output += buf;
+        appendFrame(0, true);
+        output += ",args=[]},state=\"stopped\",core=\"0\"}";
+    }
+    output += "],current-thread-id=\"1\"\n(gdb) \n";
+}
+
+static void createVar(const std::string& token, const std::vector<std::string>& args)
+{
+    // -var-create name frame-addr expression
+    std::string name = (args.size() > 1) ? args[1] : "-";
+    if (name == "-")
+    {
+        name = "var" + std::to_string(nextVarId++);
+    }
+    rootVars.insert(name);
+    char buf[256];
+    if (config.children > 0)
+    {
+        snprintf(buf, sizeof(buf),
+                 "^done,name=\"%s\",numchild=\"%d\",value=\"[%d]\",type=\"int [%d]\",thread-id=\"1\",has_more=\"0\"",
+                 name.c_str(), config.children, config.children, config.children);
+    }
+    else
+    {
+        snprintf(buf, sizeof(buf),
+                 "^done,name=\"%s\",numchild=\"0\",value=\"%d\",type=\"int\",thread-id=\"1\",has_more=\"0\"",
+                 name.c_str(), stopCount);
+    }
+    appendResult(token, buf);
+}
+
+static void listChildren(const std::string& token, const std::vector<std::string>& args)
+{
+    // -var-list-children [print-values] name [from to]
+    std::vector<std::string> rest(args.begin() + 1, args.end());
+    if (!rest.empty() && ((rest[0] == "0") || (rest[0] == "1") || (rest[0] == "2")))
+    {
+        rest.erase(rest.begin());
+    }
+    std::string name = rest.empty() ? "" : rest[0];
+    int from = 0;
+    int to = config.children;
+    if (rest.size() >= 3)
+    {
+        from = atoi(rest[1].c_str());
+        to = atoi(rest[2].c_str());
+        if (to > config.children)
+        {
+            to = config.children;
+        }
+    }
+    // only root variables have children
+    if (name.find('.') != std::string::npos)
+    {
+        from = to = 0;
+    }
+    char buf[256];
+    snprintf(buf, sizeof(buf), "^done,numchild=\"%d\",children=[", (to > from) ? (to - from) : 0);
+    output += token;
+    output += buf;
+    for (int i = from; i < to; ++i)
+    {
+        snprintf(buf, sizeof(buf),
+                 "%schild={name=\"%s.%d\",exp=\"[%d]\",numchild=\"0\",value=\"%d\",type=\"int\",thread-id=\"1\"}",
+                 (i == from) ? "" : ",", name.c_str(), i, i, i + stopCount);
+        output += buf;
+        if (output.size() > 65536)
+        {
+            flushOutput();
+        }
+    }
+    snprintf(buf, sizeof(buf), "],has_more=\"%d\"\n(gdb) \n", (to < config.children) ? 1 : 0);
+    output += buf;
+}
+
+static void updateVars(const std::string& token, const std::vector<std::string>& args)
+{
+    // -var-update [print-values] name
+    std::string name = args.empty() ? "*" : args.back();
+    output += token;
+    output += "^done,changelist=[";
+    int count = 0;
+    for (const std::string& var : rootVars)
+    {
+        if ((config.changes >= 0) && (count >= config.changes))
+        {
+            break;
+        }
+        if (((name != "*") && (var != name)) || ((name == "*") && frozenVars.count(var)))
+        {
+            continue;
+        }
+        char buf[256];
+        snprintf(buf, sizeof(buf),
+                 "%s{name=\"%s\",value=\"%d\",in_scope=\"true\",type_changed=\"false\",has_more=\"0\"}",
+                 (count == 0) ? "" : ",", var.c_str(), stopCount);
+        output += buf;
+        ++count;
+    }
+    output += "]\n(gdb) \n";
+}
+
+static void readMemory(const std::string& token, const std::vector<std::string>& args)
+{
+    // -data-read-memory-bytes [-o offset] address count
+    std::vector<std::string> rest(args.begin() + 1, args.end());
+    long long offset = 0;
+    if ((rest.size() >= 2) && (rest[0] == "-o"))
+    {
+        offset = strtoll(rest[1].c_str(), nullptr, 0);
+        rest.erase(rest.begin(), rest.begin() + 2);
+    }
+    if (rest.size() < 2)
+    {
+        appendResult(token, "^error,msg=\"Usage: ADDR COUNT.\"");
+        return;
+    }
+    unsigned long long begin = strtoull(rest[0].c_str(), nullptr, 0) + offset;
+    long long count = strtoll(rest[1].c_str(), nullptr, 0);
+    const unsigned long long end = begin + count;
+    const unsigned long long pageSize = 4096;
+    auto isReadable = [pageSize](unsigned long long address) {
+        return (config.unreadable <= 0) || (((address / pageSize) % config.unreadable) != 0);
+    };
+    // like GDB output one block for each contiguous run of readable pages
+    std::string blocks;
+    char buf[256];
+    static const char hexDigits[] = "0123456789abcdef";
+    unsigned long long blockBegin = begin;
+    while (blockBegin < end)
+    {
+        if (!isReadable(blockBegin))
+        {
+            blockBegin = ((blockBegin / pageSize) + 1) * pageSize;
+            continue;
+        }
+        unsigned long long blockEnd = blockBegin;
+        while ((blockEnd < end) && isReadable(blockEnd))
+        {
+            blockEnd = std::min(((blockEnd / pageSize) + 1) * pageSize, end);
+        }
+        // like GDB the offset of the block is relative to address + offset
+        snprintf(buf, sizeof(buf), "%s{begin=\"0x%016llx\",offset=\"0x%016llx\",end=\"0x%016llx\",contents=\"",
+                 blocks.empty() ? "" : ",", blockBegin, blockBegin - begin, blockEnd);
+        blocks += buf;
+        for (unsigned long long address = blockBegin; address < blockEnd; ++address)
+        {
+            unsigned char byte = (unsigned char)(address & 0xff);
+            blocks += hexDigits[byte >> 4];
+            blocks += hexDigits[byte & 0xf];
+        }
+        blocks += "\"}";
+        blockBegin = blockEnd;
+    }
+    if (blocks.empty() && (count > 0))
+    {
+        appendResult(token, "^error,msg=\"Unable to read memory.\"");
+        return;
+    }
+    output += token;
+    output += "^done,memory=[";
+    output += blocks;
+    output += "]\n(gdb) \n";
+}
+
+// Processes a single MI command, returns false if the debugger should exit.
+static bool processCommand(const std::string& line)
+{
+    size_t dash = line.find('-');
+    if (dash == std::string::npos)
+    {
+        appendResult("", "^error,msg=\"Only MI commands are supported.\"");
+        return true;
+    }
+    std::string token = line.substr(0, dash);
+    std::vector<std::string> args = positionalArgs(splitArgs(line.substr(dash + 1)));
+    if (args.empty())
+    {
+        appendResult(token, "^error,msg=\"Empty command.\"");
+        return true;
+    }
+    const std::string& cmd = args[0];
+    char buf[256];
+
+    if (cmd == "gdb-exit")
+    {
+        appendResult(token, "^exit");
+        return false;
+    }
+    else if ((cmd == "file-exec-and-symbols") || (cmd == "inferior-tty-set") ||
+             (cmd == "exec-arguments") || (cmd == "gdb-set") || (cmd == "environment-cd") ||
+             (cmd == "break-delete") || (cmd == "break-enable") || (cmd == "break-disable") ||
+             (cmd == "break-condition") || (cmd == "interpreter-exec") ||
+             (cmd == "var-set-update-range"))
+    {
+        appendResult(token, "^done");
+    }
+    else if (cmd == "break-insert")
+    {
+        snprintf(buf, sizeof(buf),
+                 "^done,bkpt={number=\"%d\",type=\"breakpoint\",disp=\"keep\",enabled=\"y\",addr=\"0x%016x\","
+                 "func=\"fakeFunc0\",file=\"fake.cpp\",fullname=\"/fake/fake.cpp\",line=\"1\",times=\"0\","
+                 "original-location=\"%s\"}",
+                 nextBreakpointId, 0x400000 + nextBreakpointId, args.back().c_str());
+        ++nextBreakpointId;
+        appendResult(token, buf);
+    }
+    else if (cmd == "break-after")
+    {
+        snprintf(buf, sizeof(buf),
+                 "^done,bkpt={number=\"%s\",type=\"breakpoint\",disp=\"keep\",enabled=\"y\",times=\"0\",ignore=\"%s\"}",
+                 (args.size() > 1) ? args[1].c_str() : "1", (args.size() > 2) ? args[2].c_str() : "0");
+        appendResult(token, buf);
+    }
+    else if ((cmd == "exec-run") || (cmd == "exec-continue"))
+    {
+        appendResult(token, "^running");
+        runInferior();
+        emitStopped("breakpoint-hit");
+    }
+    else if ((cmd == "exec-next") || (cmd == "exec-step") || (cmd == "exec-next-instruction") ||
+             (cmd == "exec-step-instruction") || (cmd == "exec-finish"))
+    {
+        appendResult(token, "^running");
+        output += "*running,thread-id=\"all\"\n";
+        emitStopped((cmd == "exec-finish") ? "function-finished" : "end-stepping-range");
+    }
+    else if (cmd == "exec-interrupt")
+    {
+        appendResult(token, "^done");
+        ++stopCount;
+        output += "*stopped,reason=\"signal-received\",signal-name=\"SIGINT\",frame={";
+        appendFrame(0, false);
+        output += ",args=[]},thread-id=\"1\",stopped-threads=\"all\"\n(gdb) \n";
+    }
+    else if (cmd == "target-attach")
+    {
+        // -target-attach pid [&]
+        bool isAsync = (args.back() == "&");
+        snprintf(buf, sizeof(buf), "=thread-group-started,id=\"i1\",pid=\"%s\"\n",
+                 (args.size() > 1) ? args[1].c_str() : "0");
+        output += buf;
+        for (int i = 0; i < config.threads; ++i)
+        {
+            snprintf(buf, sizeof(buf), "=thread-created,id=\"%d\",group-id=\"i1\"\n", ++threadCount);
+            output += buf;
+        }
+        hasStarted = true;
+        if (!isAsync)
+        {
+            emitStopped("signal-received");
+        }
+        appendResult(token, "^done");
+    }
+    else if (cmd == "target-detach")
+    {
+        output += "=thread-group-exited,id=\"i1\"\n";
+        threadCount = 0;
+        appendResult(token, "^done");
+    }
+    else if (cmd == "thread-info")
+    {
+        listThreads(token);
+    }
+    else if (cmd == "stack-info-depth")
+    {
+        int depth = config.frames;
+        if ((args.size() > 1) && (atoi(args[1].c_str()) < depth))
+        {
+            depth = atoi(args[1].c_str());
+        }
+        snprintf(buf, sizeof(buf), "^done,depth=\"%d\"", depth);
+        appendResult(token, buf);
+    }
+    else if (cmd == "stack-info-frame")
+    {
+        output += token;
+        output += "^done,frame={";
+        appendFrame(0, true);
+        output += "}\n(gdb) \n";
+    }
+    else if (cmd == "stack-list-frames")
+    {
+        listFrames(token, args);
+    }
+    else if (cmd == "stack-list-arguments")
+    {
+        listArguments(token, args);
+    }
+    else if (cmd == "stack-list-variables")
+    {
+        listVariables(token);
+    }
+    else if (cmd == "var-create")
+    {
+        createVar(token, args);
+    }
+    else if (cmd == "var-delete")
+    {
+        rootVars.erase(args.back());
+        frozenVars.erase(args.back());
+        appendResult(token, "^done,ndeleted=\"1\"");
+    }
+    else if (cmd == "var-list-children")
+    {
+        listChildren(token, args);
+    }
+    else if (cmd == "var-update")
+    {
+        updateVars(token, args);
+    }
+    else if (cmd == "var-set-frozen")
+    {
+        if ((args.size() > 2) && (args[2] == "1"))
+        {
+            frozenVars.insert(args[1]);
+        }
+        else if (args.size() > 1)
+        {
+            frozenVars.erase(args[1]);
+        }
+        appendResult(token, "^done");
+    }
+    else if ((cmd == "var-evaluate-expression") || (cmd == "var-set-format") ||
+             (cmd == "var-assign") || (cmd == "data-evaluate-expression"))
+    {
+        snprintf(buf, sizeof(buf), "^done,value=\"%d\"", stopCount);
+        appendResult(token, buf);
+    }
+    else if (cmd == "data-read-memory-bytes")
+    {
+        readMemory(token, args);
+    }
+    else if (cmd == "data-list-register-names")
+    {
+        appendResult(token, "^done,register-names=[\"rax\",\"rbx\",\"rcx\",\"rdx\",\"rsp\",\"rip\"]");
+    }
+    else if (cmd == "data-list-register-values")
+    {
+        output += token;
+        output += "^done,register-values=[";
+        for (int i = 0; i < 6; ++i)
+        {
+            snprintf(buf, sizeof(buf), "%s{number=\"%d\",value=\"0x%x\"}", (i == 0) ? "" : ",", i, i + stopCount);
+            output += buf;
+        }
+        output += "]\n(gdb) \n";
+    }
+    else if (cmd == "list-features")
+    {
+        appendResult(token, "^done,features=[\"frozen-varobjs\",\"pending-breakpoints\",\"data-read-memory-bytes\"]");
+    }
+    else
+    {
+        snprintf(buf, sizeof(buf), "^error,msg=\"Undefined MI command: %s\"", cmd.c_str());
+        appendResult(token, buf);
+    }
+    return true;
+}
+
+int main()
+{
+    config.threads = getConfigValue("FAKE_DEBUGGER_THREADS", 1);
+    config.threadRate = getConfigValue("FAKE_DEBUGGER_THREAD_RATE", 0);
+    config.targetOutput = getConfigValue("FAKE_DEBUGGER_TARGET_OUTPUT", 0);
+    config.frames = getConfigValue("FAKE_DEBUGGER_FRAMES", 3);
+    config.children = getConfigValue("FAKE_DEBUGGER_CHILDREN", 0);
+    config.locals = getConfigValue("FAKE_DEBUGGER_LOCALS", 2);
+    config.changes = getConfigValue("FAKE_DEBUGGER_CHANGES", -1);
+    config.unreadable = getConfigValue("FAKE_DEBUGGER_UNREADABLE", 0);
+
+    // when synced with stdio std::cin reads one character at a time, so in_avail() (which is used
+    // below to batch the responses to pipelined commands) would always return zero
+    std::ios::sync_with_stdio(false);
+
+    output += "=thread-group-added,id=\"i1\"\n(gdb) \n";
+    flushOutput();
+
+    std::string line;
+    while (std::getline(std::cin, line))
+    {
+        if (!line.empty() && (line.back() == '\r'))
+        {
+            line.pop_back();
+        }
+        if (line.empty())
+        {
+            continue;
+        }
+        bool keepGoing = processCommand(line);
+        // only flush once all the commands that are already available have been processed,
+        // so pipelined commands get their responses in one go
+        if (!keepGoing || (std::cin.rdbuf()->in_avail() <= 0))
+        {
+            flushOutput();
+        }
+        if (!keepGoing)
+        {
+            break;
+        }
+    }
+    flushOutput();
+    return 0;
+}
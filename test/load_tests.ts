@@ -0,0 +1,280 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+require('source-map-support').install();
+
+import * as chai from 'chai';
+import chaiAsPromised = require('chai-as-promised');
+import * as bunyan from 'bunyan';
+import * as stream from 'stream';
+import * as dbgmits from '../lib/index';
+import {
+  beforeEachTestWithLogger, logSuite as log, runToFunc, startFakeDebugSession,
+  IFakeDebuggerConfig
+} from './test_utils';
+
+chai.use(chaiAsPromised);
+
+// aliases
+var expect = chai.expect;
+import DebugSession = dbgmits.DebugSession;
+
+// These tests don't depend on the behavior of a real debugger, so they only need to run once
+// (as part of the GDB test run).
+log(describe("Debug Session under load @skipOnLLDB", function () {
+  this.timeout(60000);
+
+  var logger: bunyan.Logger;
+  var debugSession: DebugSession;
+
+  function startSession(config: IFakeDebuggerConfig): DebugSession {
+    debugSession = startFakeDebugSession(config, logger);
+    return debugSession;
+  }
+
+  beforeEachTestWithLogger((testLogger: bunyan.Logger) => {
+    logger = testLogger;
+    debugSession = null;
+  });
+
+  afterEach(() => {
+    if (debugSession) {
+      return debugSession.end();
+    }
+  });
+
+  it("handles a flood of thread-created notifications", () => {
+    const numThreads = 20000;
+    let numThreadsCreated = 0;
+    startSession({ threads: numThreads });
+    debugSession.on(dbgmits.EVENT_THREAD_CREATED, () => { ++numThreadsCreated; });
+    return runToFunc(debugSession, 'main', () => {
+      expect(numThreadsCreated).to.equal(numThreads);
+      return debugSession.getThreads()
+      .then((threads: dbgmits.IMultiThreadInfo) => {
+        expect(threads.all.length).to.equal(numThreads);
+      });
+    });
+  });
+
+  it("handles thread-created notifications emitted at a fixed rate", () => {
+    let numThreadsCreated = 0;
+    startSession({ threads: 100, threadRate: 1000 });
+    debugSession.on(dbgmits.EVENT_THREAD_CREATED, () => { ++numThreadsCreated; });
+    const startTime = Date.now();
+    return runToFunc(debugSession, 'main', () => {
+      expect(numThreadsCreated).to.equal(100);
+      // 100 notifications at 1000 per second should take at least 100 milliseconds to arrive
+      expect(Date.now() - startTime).to.be.at.least(90);
+      return Promise.resolve();
+    });
+  });
+
+  it("handles a flood of target output", () => {
+    const numLines = 50000;
+    let numLinesReceived = 0;
+    startSession({ targetOutput: numLines });
+    debugSession.on(dbgmits.EVENT_TARGET_OUTPUT, () => { ++numLinesReceived; });
+    return runToFunc(debugSession, 'main', () => {
+      expect(numLinesReceived).to.equal(numLines);
+      return Promise.resolve();
+    });
+  });
+
+  it("retrieves a huge list of watch children", () => {
+    const numChildren = 100000;
+    startSession({ children: numChildren });
+    return runToFunc(debugSession, 'main', () => {
+      return debugSession.addWatch('hugeArray')
+      .then((watch: dbgmits.IWatchInfo) => {
+        expect(watch.childCount).to.equal(numChildren);
+        return debugSession.getWatchChildren(watch.id, { detail: dbgmits.VariableDetailLevel.All });
+      })
+      .then((children: dbgmits.IWatchChildInfo[]) => {
+        expect(children.length).to.equal(numChildren);
+        expect(children[numChildren - 1]).to.have.property('expressionType', 'int');
+      });
+    });
+  });
+
+  it("pages through a huge list of watch children", () => {
+    const numChildren = 100000;
+    const pageSize = 1000;
+    const maxPages = 4;
+    startSession({ children: numChildren });
+    let pager: dbgmits.WatchChildPager;
+    return runToFunc(debugSession, 'main', () => {
+      return debugSession.addWatch('hugeArray')
+      .then((watch: dbgmits.IWatchInfo) => {
+        pager = new dbgmits.WatchChildPager(debugSession, watch.id, { pageSize, maxPages });
+        // scroll through the first 20 pages, half a page at a time
+        let done = Promise.resolve();
+        for (let i = 0; i < 40; ++i) {
+          const from = i * (pageSize / 2);
+          done = done
+          .then(() => pager.getChildren(from, pageSize))
+          .then((children: dbgmits.IWatchChildInfo[]) => {
+            expect(children).to.have.length(pageSize);
+            expect(children[0]).to.have.property('expression', `[${from}]`);
+          });
+        }
+        return done;
+      })
+      .then(() => {
+        // the read-ahead page may still be loading, hence the +1
+        expect(pager.cachedPageCount).to.be.at.most(maxPages + 1);
+        expect(debugSession.watchTree.size).to.be.at.most(1 + ((maxPages + 1) * pageSize));
+        return pager.getChildren(numChildren - 10, 100);
+      })
+      .then((children: dbgmits.IWatchChildInfo[]) => {
+        expect(children).to.have.length(10);
+        expect(pager.childCount).to.equal(numChildren);
+        return pager.dispose();
+      })
+      .then(() => {
+        expect(debugSession.watchTree.size).to.equal(1);
+      });
+    });
+  });
+
+  it("updates only the visible watches after a stop", () => {
+    const numWatches = 1000;
+    const numVisible = 10;
+    startSession({});
+    const specs: dbgmits.IWatchSpec[] = [];
+    for (let i = 0; i < numWatches; ++i) {
+      specs.push({ expression: `var${i}` });
+    }
+    let watchIds: string[];
+    return debugSession.addWatches(specs)
+    .then((results: dbgmits.IWatchCreationResult[]) => {
+      watchIds = results.map((result: dbgmits.IWatchCreationResult) => result.watch.id);
+      return Promise.all(watchIds.slice(0, numVisible).map(
+        (id: string) => debugSession.setWatchVisibility(id, true)
+      ));
+    })
+    .then(() => runToFunc(debugSession, 'main', () => {
+      return debugSession.updateVisibleWatches()
+      .then((updates: dbgmits.IWatchUpdateInfo[]) => {
+        expect(updates).to.have.length(numVisible);
+        const tree = debugSession.watchTree;
+        expect(tree.getNode(watchIds[0]).isStale).to.be.false;
+        expect(tree.getNode(watchIds[numWatches - 1]).isStale).to.be.true;
+        // a hidden watch is brought up to date as soon as it becomes visible
+        return debugSession.setWatchVisibility(watchIds[numWatches - 1], true)
+        .then(() => {
+          expect(tree.getNode(watchIds[numWatches - 1]).isStale).to.be.false;
+        });
+      });
+    }));
+  });
+
+  it("notifies watch subscribers after a stop", () => {
+    startSession({});
+    const updatedWatches: string[] = [];
+    let onUpdated: Promise<void>;
+    let a: string;
+    let b: string;
+    return debugSession.addWatches([{ expression: 'a' }, { expression: 'b' }, { expression: 'c' }])
+    .then((results: dbgmits.IWatchCreationResult[]) => {
+      [a, b] = results.map((result: dbgmits.IWatchCreationResult) => result.watch.id);
+      const listener = (update: dbgmits.IWatchUpdateInfo) => { updatedWatches.push(update.id); };
+      // subscribing the same listener to a watch more than once has no effect
+      debugSession.subscribeWatch(a, listener);
+      debugSession.subscribeWatch(a, listener);
+      debugSession.subscribeWatch(b, listener).unsubscribe();
+      onUpdated = new Promise<void>((resolve) => {
+        debugSession.subscribeWatch(a, () => resolve());
+      });
+      return runToFunc(debugSession, 'main', () => onUpdated);
+    })
+    .then(() => {
+      expect(updatedWatches).to.deep.equal([a]);
+    });
+  });
+
+  it("retrieves a very deep stack", () => {
+    const numFrames = 10000;
+    startSession({ frames: numFrames });
+    return runToFunc(debugSession, 'main', () => {
+      return debugSession.getStackDepth()
+      .then((depth: number) => {
+        expect(depth).to.equal(numFrames);
+        return debugSession.getStackFrames();
+      })
+      .then((frames: dbgmits.IStackFrameInfo[]) => {
+        expect(frames.length).to.equal(numFrames);
+        expect(frames[numFrames - 1]).to.have.property('level', numFrames - 1);
+      });
+    });
+  });
+
+  it("records the unreadable parts of a memory range as gaps", () => {
+    // every 3rd page can't be read, so pages 0, 3, 6, and 9 are gaps
+    startSession({ unreadable: 3 });
+    const numBytes = 40000;
+    const readRange = (fillGaps: boolean) => {
+      const chunks: Buffer[] = [];
+      const outStream = new stream.Writable({
+        write: (chunk: Buffer, encoding: string, callback: Function) => {
+          chunks.push(chunk);
+          callback();
+        }
+      });
+      // the blocks don't line up with the pages, so some gaps span two blocks
+      const reader = new dbgmits.MemoryRangeReader(
+        debugSession, '0x0', numBytes, { blockSize: 5000, maxBlocksInFlight: 3, fillGaps }
+      );
+      return reader.readToStream(outStream)
+      .then((result: dbgmits.IMemoryReadResult) => ({ result, contents: Buffer.concat(chunks) }));
+    };
+    return readRange(true)
+    .then(({ result, contents }) => {
+      expect(result.isComplete).to.be.true;
+      expect(result.gaps).to.deep.equal([
+        { offset: 0, length: 4096 },
+        { offset: 12288, length: 4096 },
+        { offset: 24576, length: 4096 },
+        { offset: 36864, length: 3136 }
+      ]);
+      expect(result.bytesRead).to.equal(24576);
+      expect(result.bytesUnreadable).to.equal(numBytes - 24576);
+      // the gaps are filled with zeroes so every byte stays at its offset in the range, and the
+      // fake debugger reads the low byte of the address at every readable address
+      expect(contents.length).to.equal(numBytes);
+      expect(contents[4095]).to.equal(0);
+      expect(contents[4097]).to.equal(1);
+      expect(contents[12287]).to.equal(0xff);
+      expect(contents[12288]).to.equal(0);
+      expect(contents[16384 + 0x12]).to.equal(0x12);
+      return readRange(false);
+    })
+    .then(({ result, contents }) => {
+      expect(result.gaps).to.have.length(4);
+      // without the zeroes the pages that could be read are written out back to back
+      expect(contents.length).to.equal(24576);
+      expect(contents[0]).to.equal(0);
+      expect(contents[8191]).to.equal(0xff);
+      expect(contents[8192]).to.equal(0);
+      expect(contents[8192 + 0x34]).to.equal(0x34);
+    });
+  });
+
+  it("pipelines a large number of commands", () => {
+    const numBreakpoints = 5000;
+    startSession({});
+    const locations: string[] = [];
+    for (let i = 0; i < numBreakpoints; ++i) {
+      locations.push(`func${i}`);
+    }
+    return debugSession.pipelineCommands(() => {
+      return Promise.all(locations.map((location: string) => debugSession.addBreakpoint(location)));
+    })
+    .then((breakpoints: dbgmits.IBreakpointInfo[]) => {
+      expect(breakpoints.length).to.equal(numBreakpoints);
+      breakpoints.forEach((breakpoint: dbgmits.IBreakpointInfo, i: number) => {
+        expect(breakpoint.id).to.equal(i + 1);
+      });
+    });
+  });
+}));
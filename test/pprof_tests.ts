@@ -0,0 +1,169 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+require('source-map-support').install();
+
+import * as chai from 'chai';
+import * as zlib from 'zlib';
+import { encodePprofProfile, IPprofProfile } from '../lib/pprof';
+
+// aliases
+var expect = chai.expect;
+
+/** A protocol buffer field, the value is either a varint (as 7-bit groups) or a byte string. */
+interface IProtobufField {
+  field: number;
+  varint?: number[];
+  bytes?: Buffer;
+}
+
+/** Converts the 7-bit groups of a varint (least significant first) to a number. */
+function groupsToNumber(groups: number[]): number {
+  return groups.reduceRight((n: number, group: number) => (n * 0x80) + group, 0);
+}
+
+/** Converts the 7-bit groups of a varint to hex digits without losing precision. */
+function groupsToHex(groups: number[]): string {
+  let bits = groups.map((group: number) => ('000000' + group.toString(2)).slice(-7))
+    .reverse().join('').replace(/^0+/, '');
+  bits = ('000'.substr(0, (4 - (bits.length % 4)) % 4)) + bits;
+  let hex = '';
+  for (let i = 0; i < bits.length; i += 4) {
+    hex += parseInt(bits.substr(i, 4), 2).toString(16);
+  }
+  return hex || '0';
+}
+
+/** Decodes the fields of a protocol buffer message, only varints and byte strings are expected. */
+function decodeMessage(buffer: Buffer): IProtobufField[] {
+  const fields: IProtobufField[] = [];
+  let pos = 0;
+  const readVarint = (): number[] => {
+    const groups: number[] = [];
+    let byte: number;
+    do {
+      byte = buffer[pos++];
+      groups.push(byte % 0x80);
+    } while (byte >= 0x80);
+    return groups;
+  };
+  while (pos < buffer.length) {
+    const key = groupsToNumber(readVarint());
+    const field = Math.floor(key / 8);
+    const wireType = key % 8;
+    if (wireType === 0) {
+      fields.push({ field, varint: readVarint() });
+    } else if (wireType === 2) {
+      const length = groupsToNumber(readVarint());
+      fields.push({ field, bytes: buffer.slice(pos, pos + length) });
+      pos += length;
+    } else {
+      throw new Error(`Unexpected wire type ${wireType}.`);
+    }
+  }
+  expect(pos).to.equal(buffer.length);
+  return fields;
+}
+
+function getFields(fields: IProtobufField[], field: number): IProtobufField[] {
+  return fields.filter((f: IProtobufField) => f.field === field);
+}
+
+function getNumber(fields: IProtobufField[], field: number): number {
+  const matches = getFields(fields, field);
+  // fields with default values are omitted
+  return (matches.length > 0) ? groupsToNumber(matches[0].varint) : 0;
+}
+
+function decodePacked(fields: IProtobufField[], field: number): number[] {
+  const values: number[] = [];
+  getFields(fields, field).forEach((packedField: IProtobufField) => {
+    let groups: number[] = [];
+    for (let i = 0; i < packedField.bytes.length; ++i) {
+      groups.push(packedField.bytes[i] % 0x80);
+      if (packedField.bytes[i] < 0x80) {
+        values.push(groupsToNumber(groups));
+        groups = [];
+      }
+    }
+  });
+  return values;
+}
+
+describe("pprof", () => {
+  const profile: IPprofProfile = {
+    sampleTypes: [{ type: 'samples', unit: 'count' }],
+    samples: [
+      { locationIds: [1, 2], values: [3] },
+      { locationIds: [2], values: [300] }
+    ],
+    locations: [
+      { id: 1, address: '0xffffffffff600000', functionId: 1, line: 10 },
+      { id: 2, address: '0x00007fffffffe0a0', functionId: 2, line: 0 }
+    ],
+    functions: [
+      { id: 1, name: 'inner', filename: 'test.cpp' },
+      { id: 2, name: 'main', filename: 'test.cpp' }
+    ],
+    timeMs: 1500000000000,
+    durationMs: 2.5,
+    periodType: { type: 'cpu', unit: 'nanoseconds' },
+    period: 100000000
+  };
+  let fields: IProtobufField[];
+
+  before(() => {
+    fields = decodeMessage(zlib.gunzipSync(encodePprofProfile(profile)));
+  });
+
+  it("writes the string table in order of first use, starting with the empty string", () => {
+    const strings = getFields(fields, 6).map((f: IProtobufField) => f.bytes.toString('utf8'));
+    expect(strings).to.deep.equal(
+      ['', 'samples', 'count', 'inner', 'test.cpp', 'main', 'cpu', 'nanoseconds']
+    );
+    const sampleTypes = getFields(fields, 1).map((f: IProtobufField) => decodeMessage(f.bytes));
+    expect(sampleTypes).to.have.length(1);
+    expect(getNumber(sampleTypes[0], 1)).to.equal(1);
+    expect(getNumber(sampleTypes[0], 2)).to.equal(2);
+    const periodType = decodeMessage(getFields(fields, 11)[0].bytes);
+    expect(getNumber(periodType, 1)).to.equal(6);
+    expect(getNumber(periodType, 2)).to.equal(7);
+  });
+
+  it("writes the samples with packed location ids and values", () => {
+    const samples = getFields(fields, 2).map((f: IProtobufField) => decodeMessage(f.bytes));
+    expect(samples).to.have.length(2);
+    expect(decodePacked(samples[0], 1)).to.deep.equal([1, 2]);
+    expect(decodePacked(samples[0], 2)).to.deep.equal([3]);
+    expect(decodePacked(samples[1], 1)).to.deep.equal([2]);
+    expect(decodePacked(samples[1], 2)).to.deep.equal([300]);
+  });
+
+  it("writes the locations and functions", () => {
+    const locations = getFields(fields, 4).map((f: IProtobufField) => decodeMessage(f.bytes));
+    expect(locations).to.have.length(2);
+    expect(getNumber(locations[0], 1)).to.equal(1);
+    const line = decodeMessage(getFields(locations[0], 4)[0].bytes);
+    expect(getNumber(line, 1)).to.equal(1);
+    expect(getNumber(line, 2)).to.equal(10);
+    expect(getNumber(locations[1], 1)).to.equal(2);
+
+    const functions = getFields(fields, 5).map((f: IProtobufField) => decodeMessage(f.bytes));
+    expect(functions).to.have.length(2);
+    expect(getNumber(functions[1], 1)).to.equal(2);
+    // name, system name, and filename are indices into the string table
+    expect(getNumber(functions[1], 2)).to.equal(5);
+    expect(getNumber(functions[1], 3)).to.equal(5);
+    expect(getNumber(functions[1], 4)).to.equal(4);
+  });
+
+  it("writes varints that don't fit in a number without losing precision", () => {
+    const locations = getFields(fields, 4).map((f: IProtobufField) => decodeMessage(f.bytes));
+    expect(groupsToHex(getFields(locations[0], 3)[0].varint)).to.equal('ffffffffff600000');
+    expect(groupsToHex(getFields(locations[1], 3)[0].varint)).to.equal('7fffffffe0a0');
+    // 1500000000000 ms in nanoseconds
+    expect(groupsToHex(getFields(fields, 9)[0].varint)).to.equal('14d1120d7b160000');
+    expect(getNumber(fields, 10)).to.equal(2500000);
+    expect(getNumber(fields, 12)).to.equal(100000000);
+  });
+});
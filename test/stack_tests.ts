@@ -139,8 +139,152 @@ log(describe("Debug Session", () => {
           });
         });
       });
+
+      it("gets compact stack frames with interned strings", () => {
+        return runToFunc(debugSession, 'funcAtFrameLevel0', () => {
+          let plainFrames: dbgmits.IStackFrameInfo[];
+          return debugSession.getStackFrames()
+          .then((frames: dbgmits.IStackFrameInfo[]) => {
+            plainFrames = frames;
+            debugSession.internFrameStrings = true;
+            return debugSession.getStackFrames();
+          })
+          .then((frames: dbgmits.IStackFrameInfo[]) => {
+            expect(frames[0]).to.be.instanceof(dbgmits.CompactStackFrame);
+            expect(frames[0].func).match(/^funcAtFrameLevel0/);
+            expect(frames[0].fullname).to.equal(frames[1].fullname);
+            expect(JSON.parse(JSON.stringify(frames))).to.deep.equal(
+              JSON.parse(JSON.stringify(plainFrames))
+            );
+          });
+        });
+      });
     }); // #getStackFrames
 
+    describe("#iterateStackFrames", () => {
+      it("iterates over all the frames of a deep stack one page at a time", () => {
+        return runToFunc(debugSession, 'funcAtBottomOfDeepRecursion', () => {
+          const iterator = debugSession.iterateStackFrames({ pageSize: 64 });
+          let expectedStackDepth = -1;
+          let numPages = 0;
+          const frames: dbgmits.IStackFrameInfo[] = [];
+          return debugSession.getStackDepth()
+          .then((stackDepth: number) => { expectedStackDepth = stackDepth; })
+          .then(() => iterator.forEach((page: dbgmits.IStackFrameInfo[]) => {
+            ++numPages;
+            expect(page.length).to.be.at.most(64);
+            frames.push(...page);
+          }))
+          .then(() => {
+            expect(frames.length).to.equal(expectedStackDepth);
+            expect(numPages).to.equal(Math.ceil(expectedStackDepth / 64));
+            for (let i = 0; i < frames.length; ++i) {
+              expect(frames[i].level).to.equal(i);
+            }
+            expect(frames[0].func).match(/^funcAtBottomOfDeepRecursion/);
+            // the target recurses 1000 levels deep by default
+            for (let i = 1; i <= 1000; ++i) {
+              expect(frames[i].func).match(/^funcWithDeepRecursion/);
+            }
+            return iterator.next();
+          })
+          .then((result: IteratorResult<dbgmits.IStackFrameInfo[]>) => {
+            expect(result.done).to.be.true;
+          });
+        });
+      });
+
+      it("stops iterating at the maximum depth @skipOnLLDB", () => {
+        return runToFunc(debugSession, 'funcAtBottomOfDeepRecursion', () => {
+          const iterator = debugSession.iterateStackFrames({ pageSize: 100, maxDepth: 250 });
+          let numFrames = 0;
+          return iterator.forEach((page: dbgmits.IStackFrameInfo[]) => {
+            numFrames += page.length;
+          })
+          .then(() => {
+            expect(numFrames).to.equal(250);
+            return iterator.getDepth();
+          })
+          .then((depth: number) => expect(depth).to.equal(250));
+        });
+      });
+
+      it("stops iterating when the consumer has seen enough frames", () => {
+        return runToFunc(debugSession, 'funcAtBottomOfDeepRecursion', () => {
+          const iterator = debugSession.iterateStackFrames({ pageSize: 10 });
+          let numPages = 0;
+          return iterator.forEach((page: dbgmits.IStackFrameInfo[]) => ++numPages < 3)
+          .then(() => {
+            expect(numPages).to.equal(3);
+            return iterator.next();
+          })
+          .then((result: IteratorResult<dbgmits.IStackFrameInfo[]>) => {
+            expect(result.done).to.be.true;
+          });
+        });
+      });
+    }); // #iterateStackFrames
+
+    describe("#getCachedStackFrames", () => {
+      it("reuses the outer frames after stepping out of a function", () => {
+        return runToFunc(debugSession, 'funcAtBottomOfDeepRecursion', () => {
+          const stepFinished = new Promise<void>((resolve) => {
+            debugSession.once(
+              debugSession.canEmitFunctionFinishedNotification() ?
+                dbgmits.EVENT_FUNCTION_FINISHED : dbgmits.EVENT_STEP_FINISHED,
+              () => resolve()
+            );
+          });
+          let initialFrames: dbgmits.IStackFrameInfo[];
+          return debugSession.getCachedStackFrames(1)
+          .then((frames: dbgmits.IStackFrameInfo[]) => {
+            initialFrames = frames;
+            expect(frames[0].func).match(/^funcAtBottomOfDeepRecursion/);
+            return Promise.all([stepFinished, debugSession.stepOut()]);
+          })
+          .then(() => Promise.all([
+            debugSession.getCachedStackFrames(1),
+            debugSession.getStackFrames({ threadId: 1 })
+          ]))
+          .then(([cachedFrames, frames]) => {
+            expect(cachedFrames).to.deep.equal(frames);
+            expect(cachedFrames.length).to.equal(initialFrames.length - 1);
+            const stats = debugSession.backtraceCacheStats;
+            // only the first time around should all the frames have been retrieved
+            expect(stats.framesReused).to.be.at.least(frames.length - 2);
+            expect(stats.framesRetrieved).to.be.at.most(initialFrames.length + 2);
+          });
+        });
+      });
+
+      it("retrieves all the frames again after reaching a breakpoint via another call site", () => {
+        return runToFunc(debugSession, 'funcCalledFromTwoCallSites_Inner', () => {
+          const breakpointHit = new Promise<void>((resolve) => {
+            debugSession.once(dbgmits.EVENT_BREAKPOINT_HIT, () => resolve());
+          });
+          let initialFrames: dbgmits.IStackFrameInfo[];
+          return debugSession.getCachedStackFrames(1)
+          .then((frames: dbgmits.IStackFrameInfo[]) => {
+            initialFrames = frames;
+            return Promise.all([breakpointHit, debugSession.resumeInferior()]);
+          })
+          .then(() => Promise.all([
+            debugSession.getCachedStackFrames(1),
+            debugSession.getStackFrames({ threadId: 1 })
+          ]))
+          .then(([cachedFrames, frames]) => {
+            expect(cachedFrames).to.deep.equal(frames);
+            expect(cachedFrames.length).to.equal(initialFrames.length);
+            // the inner frames are identical, only the frame of main() has changed
+            expect(cachedFrames[1].address).to.equal(initialFrames[1].address);
+            expect(cachedFrames[2].func).to.match(/^main/);
+            expect(cachedFrames[2].line).to.not.equal(initialFrames[2].line);
+            expect(debugSession.backtraceCacheStats.framesReused).to.equal(0);
+          });
+        });
+      });
+    }); // #getCachedStackFrames
+
     describe("#getStackFrameArgs", () => {
       it("gets frame arguments for a number of frames", () => {
         return runToFunc(debugSession, 'funcWithNoArgs', () => {
@@ -179,6 +323,58 @@ log(describe("Debug Session", () => {
       });
     }); // #getStackFrameArgs
 
+    describe("#getStackFramesDetailed", () => {
+      it("gets frames along with their arguments", () => {
+        return runToFunc(debugSession, 'funcWithNoArgs', () => {
+          return debugSession.getStackFramesDetailed({
+            lowFrame: 0, highFrame: 3, detail: dbgmits.VariableDetailLevel.All
+          })
+          .then((frames: dbgmits.IStackFrameDetailedInfo[]) => {
+            expect(frames.map(frame => frame.level)).to.deep.equal([0, 1, 2, 3]);
+            expect(frames[0].func).match(/^funcWithNoArgs/);
+            expect(frames[0].args).to.have.length(0);
+            expect(frames[1].func).match(/^funcWithOneSimpleArg/);
+            expect(frames[1].args).to.deep.equal([{ name: 'a', value: '5' }]);
+            expect(frames[2].func).match(/^funcWithTwoArgs/);
+            expect(frames[2].args.map(arg => arg.name)).to.deep.equal(['b', 'c']);
+            expect(frames[3].func).match(/^funcWithThreeArgs/);
+            expect(frames[3].args.map(arg => arg.name)).to.deep.equal(['d', 'e', 'f']);
+            expect(frames[3].locals).to.be.undefined;
+          });
+        });
+      });
+
+      it("gets frames along with the names of their arguments", () => {
+        return runToFunc(debugSession, 'funcWithNoArgs', () => {
+          return debugSession.getStackFramesDetailed({
+            lowFrame: 2, detail: dbgmits.VariableDetailLevel.None
+          })
+          .then((frames: dbgmits.IStackFrameDetailedInfo[]) => {
+            expect(frames[0].level).to.equal(2);
+            expect(frames[0].args).to.deep.equal([{ name: 'b' }, { name: 'c' }]);
+            expect(frames[1].args).to.deep.equal([{ name: 'd' }, { name: 'e' }, { name: 'f' }]);
+          });
+        });
+      });
+
+      it("gets frames along with their arguments and locals", () => {
+        return runToFunc(debugSession, 'funcWithThreeLocalVariables_Inner', () => {
+          return debugSession.getStackFramesDetailed({
+            threadId: 1, lowFrame: 0, highFrame: 1, includeLocals: true,
+            detail: dbgmits.VariableDetailLevel.All
+          })
+          .then((frames: dbgmits.IStackFrameDetailedInfo[]) => {
+            expect(frames).to.have.length(2);
+            expect(frames[0].locals).to.have.length(0);
+            expect(frames[1].func).match(/^funcWithThreeLocalVariables/);
+            expect(frames[1].args).to.have.length(0);
+            expect(frames[1].locals.map(local => local.name)).to.deep.equal(['e', 'f', 'g']);
+            expect(frames[1].locals[2]).to.have.property('value', '300');
+          });
+        });
+      });
+    }); // #getStackFramesDetailed
+
     describe("#getStackFrameVariables", () => {
       it("gets a single simple local variable (name only) for a frame", () => {
         return runToFunc(debugSession, 'funcWithOneSimpleLocalVariable_Inner', () => {
@@ -418,5 +614,86 @@ log(describe("Debug Session", () => {
         });
       });
     }); // #getStackFrameVariables
+
+    describe("#getProcessSnapshot", () => {
+      // FIXME: re-enable on LLDB when it's fixed to handle --thread and --frame arguments
+      it("captures the frames, arguments, and locals of the current thread @skipOnLLDB", () => {
+        return runToFunc(debugSession, 'funcWithOneSimpleArg', () => {
+          return debugSession.getProcessSnapshot()
+          .then((snapshot: dbgmits.IProcessSnapshot) => {
+            expect(snapshot.currentThreadId).to.equal(1);
+            expect(snapshot.threads.length).to.equal(1);
+            const thread = snapshot.threads[0];
+            expect(thread.errors).to.be.undefined;
+            expect(thread.frames[0].func).match(/^funcWithOneSimpleArg/);
+            expect(thread.frames[0].args.length).to.equal(1);
+            expect(thread.frames[0].args[0]).to.have.property('name', 'a');
+            expect(thread.frames[0].args[0]).to.have.property('value', '5');
+            expect(thread.frames[1].func).match(/^funcWithTwoArgs/);
+            expect(thread.frames[1].args.length).to.equal(2);
+          });
+        });
+      });
+
+      it("captures a limited number of frames along with registers @skipOnLLDB", () => {
+        return runToFunc(debugSession, 'funcAtFrameLevel0', () => {
+          return debugSession.getProcessSnapshot({
+            maxFrames: 2, includeLocals: false, includeRegisters: true
+          })
+          .then((snapshot: dbgmits.IProcessSnapshot) => {
+            const thread = snapshot.threads[0];
+            expect(thread.frames.length).to.equal(2);
+            expect(thread.frames[1].func).match(/^funcAtFrameLevel1/);
+            expect(thread.frames[1].args).to.be.empty;
+            expect(thread.frames[1].locals).to.be.undefined;
+            expect(thread.registers).to.be.an('object');
+            expect(Object.keys(thread.registers)).to.not.be.empty;
+          });
+        });
+      });
+
+      it("serializes a snapshot to NDJSON @skipOnLLDB", () => {
+        return runToFunc(debugSession, 'funcAtFrameLevel0', () => {
+          return debugSession.getProcessSnapshot()
+          .then((snapshot: dbgmits.IProcessSnapshot) => {
+            const lines = dbgmits.formatSnapshotAsNDJSON(snapshot, 'test').split('\n');
+            // one line for the process, one for the thread, and the trailing newline
+            expect(lines.length).to.equal(3);
+            expect(JSON.parse(lines[0])).to.have.property('type', 'process');
+            expect(JSON.parse(lines[0])).to.have.property('source', 'test');
+            expect(JSON.parse(lines[1])).to.have.property('type', 'thread');
+            expect(JSON.parse(lines[1])).to.have.property('frames').that.is.not.empty;
+            expect(lines[2]).to.equal('');
+          });
+        });
+      });
+
+      it("captures the same snapshot with the Python helper @skipOnLLDB", function () {
+        let snapshot: dbgmits.IProcessSnapshot;
+        const summarize = (frames: dbgmits.IStackFrameDetailedInfo[]) => frames.map((frame) => ({
+          level: frame.level, func: frame.func, line: frame.line, args: frame.args
+        }));
+        return runToFunc(debugSession, 'funcWithOneSimpleArg', () => {
+          return debugSession.getProcessSnapshot({ detail: dbgmits.VariableDetailLevel.All })
+          .then((result: dbgmits.IProcessSnapshot) => {
+            snapshot = result;
+            return debugSession.loadPythonHelper();
+          })
+          .then((isLoaded: boolean) => {
+            if (!isLoaded) {
+              // the debugger doesn't support the helper
+              this.skip();
+            }
+            return debugSession.getProcessSnapshot({ detail: dbgmits.VariableDetailLevel.All });
+          })
+          .then((helperSnapshot: dbgmits.IProcessSnapshot) => {
+            expect(helperSnapshot.threads.length).to.equal(snapshot.threads.length);
+            expect(helperSnapshot.threads[0].errors).to.be.undefined;
+            expect(summarize(helperSnapshot.threads[0].frames))
+              .to.deep.equal(summarize(snapshot.threads[0].frames));
+          });
+        });
+      });
+    }); // #getProcessSnapshot
   });
 }));
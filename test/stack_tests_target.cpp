@@ -1,4 +1,6 @@
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 struct Point
 {
@@ -114,8 +116,49 @@ void funcAtFrameLevel1()
     return;
 }
 
+// This function is just used as a location marker at the bottom of the recursion in
+// funcWithDeepRecursion().
+void funcAtBottomOfDeepRecursion()
+{
+    return;
+}
+
+// Recurses until the stack is `depth` frames deeper than it was when the function was first
+// called, used to test and benchmark the retrieval of very deep stacks.
+int funcWithDeepRecursion(int depth)
+{
+    if (depth <= 1)
+    {
+        funcAtBottomOfDeepRecursion();
+        return 0;
+    }
+    // the addition prevents the compiler from turning the recursion into a loop
+    return funcWithDeepRecursion(depth - 1) + 1;
+}
+
+void funcCalledFromTwoCallSites_Inner()
+{
+    return;
+}
+
+// Called from two different lines in main(), so the stack below funcCalledFromTwoCallSites_Inner()
+// is identical at both breaks except for the frame of main().
+void funcCalledFromTwoCallSites()
+{
+    funcCalledFromTwoCallSites_Inner();
+}
+
 int main(int argc, const char *argv[])
 {
+    int recursionDepth = 1000;
+    if (argc == 3)
+    {
+        if (strcmp(argv[1], "--recursion-depth") == 0)
+        {
+            recursionDepth = atoi(argv[2]);
+        }
+    }
+
     funcAtFrameLevel1();
 
     funcWithOneSimpleLocalVariable();
@@ -125,6 +168,11 @@ int main(int argc, const char *argv[])
     
     int threeInts[] = { 1, 2, 3 };
     funcWithThreeArgs(300, "Test", threeInts);
+
+    funcCalledFromTwoCallSites();
+    funcCalledFromTwoCallSites();
+
+    funcWithDeepRecursion(recursionDepth);
     
     return 0;
 }
@@ -31,80 +31,167 @@ export function startDebugSession(logger?: bunyan.Logger): DebugSession {
   const debuggerType = ('lldb' === process.env['DBGMITS_DEBUGGER']) ? dbgmits.DebuggerType.LLDB : dbgmits.DebuggerType.GDB;
   let debugSession: DebugSession = dbgmits.startDebugSession(debuggerType);
   if (logger) {
-    debugSession.logger = logger;
+    addSessionLogging(debugSession, logger);
+  }
+  return debugSession;
+}
 
-    // log event data emitted by DebugSession
-    let eventsToLog = [
-      dbgmits.EVENT_TARGET_RUNNING,
-      dbgmits.EVENT_TARGET_STOPPED,
-      dbgmits.EVENT_BREAKPOINT_HIT,
-      dbgmits.EVENT_STEP_FINISHED,
-      dbgmits.EVENT_FUNCTION_FINISHED,
-      dbgmits.EVENT_SIGNAL_RECEIVED,
-      dbgmits.EVENT_EXCEPTION_RECEIVED,
-      dbgmits.EVENT_THREAD_GROUP_ADDED,
-      dbgmits.EVENT_THREAD_GROUP_REMOVED,
-      dbgmits.EVENT_THREAD_GROUP_STARTED,
-      dbgmits.EVENT_THREAD_GROUP_EXITED,
-      dbgmits.EVENT_THREAD_CREATED,
-      dbgmits.EVENT_THREAD_EXITED,
-      dbgmits.EVENT_THREAD_SELECTED,
-      dbgmits.EVENT_LIB_LOADED,
-      dbgmits.EVENT_LIB_UNLOADED,
-    ];
-    eventsToLog.forEach((eventName: string) => {
-      debugSession.on(eventName, (data: any) => {
-        if (debugSession.logger) {
-          debugSession.logger.debug({ event: eventName, data: data });
-        }
-      });
-    });
+/** Load generated by the fake debugger, see `test/fake_debugger.cpp` for details. */
+export interface IFakeDebuggerConfig {
+  /** Number of thread-created notifications to emit when the inferior is started. */
+  threads?: number;
+  /** Maximum number of thread-created notifications to emit per second. */
+  threadRate?: number;
+  /** Number of target output records to emit every time the inferior is resumed. */
+  targetOutput?: number;
+  /** Depth of the stack of every thread. */
+  frames?: number;
+  /** Number of children of every watch. */
+  children?: number;
+  /** Number of locals in every frame. */
+  locals?: number;
+  /** Number of entries in every watch changelist. */
+  changes?: number;
+  /** If non-zero every Nth 4 KB page of memory can't be read. */
+  unreadable?: number;
+}
 
-    // monkey-patch DebugSession methods that return non-void promises and log the values
-    // the promises are resolved with
-    let functionsToLog: string[] = [
-      'addBreakpoint',
-      'ignoreBreakpoint',
-      'getStackFrame',
-      'getStackDepth',
-      'getStackFrames',
-      'getStackFrameArgs',
-      'getStackFrameVariables',
-      'addWatch',
-      'updateWatch',
-      'getWatchChildren',
-      'setWatchValueFormat',
-      'getWatchValue',
-      'setWatchValue',
-      'getWatchAttributes',
-      'getWatchExpression',
-      'evaluateExpression',
-      'readMemory',
-      'getRegisterNames',
-      'getRegisterValues',
-      'disassembleAddressRange',
-      'disassembleAddressRangeByLine',
-      'disassembleFile',
-      'disassembleFileByLine',
-      'getThread',
-      'getThreads'
-    ];
-    functionsToLog.forEach((funcName: string) => {
-      let func: Function = (<any> debugSession)[funcName];
-      (<any> debugSession)[funcName] = function () {
-        return func.apply(this, arguments)
-        .then((result: any) => {
-          if (debugSession.logger) {
-            debugSession.logger.debug({ func: funcName, result: result });
-          }
-          return result;
-        });
-      };
-    });
+/**
+ * Starts a debug session backed by the fake debugger instead of GDB or LLDB.
+ *
+ * The fake debugger speaks a subset of GDB/MI and can generate load at rates a real debugger
+ * can't produce on demand, so it's used to stress the MI driver rather than to test the behavior
+ * of a real debugger.
+ *
+ * NOTE: The fake debugger is built along with the other target executables by the
+ *       `npm run configure-tests` command.
+ *
+ * @param config Load the fake debugger should generate.
+ * @param logger Optional logger to pass through to the debug session.
+ */
+export function startFakeDebugSession(
+  config: IFakeDebuggerConfig, logger?: bunyan.Logger): DebugSession {
+  const envVars: { [name: string]: number } = {
+    FAKE_DEBUGGER_THREADS: config.threads,
+    FAKE_DEBUGGER_THREAD_RATE: config.threadRate,
+    FAKE_DEBUGGER_TARGET_OUTPUT: config.targetOutput,
+    FAKE_DEBUGGER_FRAMES: config.frames,
+    FAKE_DEBUGGER_CHILDREN: config.children,
+    FAKE_DEBUGGER_LOCALS: config.locals,
+    FAKE_DEBUGGER_CHANGES: config.changes,
+    FAKE_DEBUGGER_UNREADABLE: config.unreadable
+  };
+  // the fake debugger inherits its configuration from the environment of this process
+  Object.keys(envVars).forEach((name: string) => {
+    if (envVars[name] !== undefined) {
+      process.env[name] = envVars[name].toString();
+    } else {
+      delete process.env[name];
+    }
+  });
+  let debugSession: DebugSession;
+  try {
+    debugSession = dbgmits.startDebugSession(
+      dbgmits.DebuggerType.GDB, getLocalTargetExe('fake_debugger')
+    );
+  } finally {
+    Object.keys(envVars).forEach((name: string) => { delete process.env[name]; });
+  }
+  if (logger) {
+    addSessionLogging(debugSession, logger);
   }
   return debugSession;
 }
 
+/** Logs the events emitted by a debug session, and the results of its commands. */
+function addSessionLogging(debugSession: DebugSession, logger: bunyan.Logger): void {
+  debugSession.logger = logger;
+
+  // log event data emitted by DebugSession
+  let eventsToLog = [
+    dbgmits.EVENT_TARGET_RUNNING,
+    dbgmits.EVENT_TARGET_STOPPED,
+    dbgmits.EVENT_BREAKPOINT_HIT,
+    dbgmits.EVENT_STEP_FINISHED,
+    dbgmits.EVENT_FUNCTION_FINISHED,
+    dbgmits.EVENT_SIGNAL_RECEIVED,
+    dbgmits.EVENT_EXCEPTION_RECEIVED,
+    dbgmits.EVENT_THREAD_GROUP_ADDED,
+    dbgmits.EVENT_THREAD_GROUP_REMOVED,
+    dbgmits.EVENT_THREAD_GROUP_STARTED,
+    dbgmits.EVENT_THREAD_GROUP_EXITED,
+    dbgmits.EVENT_THREAD_CREATED,
+    dbgmits.EVENT_THREAD_EXITED,
+    dbgmits.EVENT_THREAD_SELECTED,
+    dbgmits.EVENT_LIB_LOADED,
+    dbgmits.EVENT_LIB_UNLOADED,
+  ];
+  eventsToLog.forEach((eventName: string) => {
+    debugSession.on(eventName, (data: any) => {
+      if (debugSession.logger) {
+        debugSession.logger.debug({ event: eventName, data: data });
+      }
+    });
+  });
+
+  // monkey-patch DebugSession methods that return non-void promises and log the values
+  // the promises are resolved with
+  let functionsToLog: string[] = [
+    'addBreakpoint',
+    'ignoreBreakpoint',
+    'getStackFrame',
+    'getStackDepth',
+    'getStackFrames',
+    'getStackFramesDetailed',
+    'getCachedStackFrames',
+    'getStackFrameArgs',
+    'getStackFrameVariables',
+    'addWatch',
+    'addWatches',
+    'acquireWatch',
+    'updateVisibleWatches',
+    'setWatchFrozen',
+    'updateWatch',
+    'getWatchChildren',
+    'setWatchValueFormat',
+    'getWatchValue',
+    'getWatchValues',
+    'setWatchValue',
+    'getWatchAttributes',
+    'getWatchExpression',
+    'evaluateExpression',
+    'evaluateExpressions',
+    'readMemory',
+    'readMemoryBuffer',
+    'writeMemory',
+    'getRegisterNames',
+    'getRegisterValues',
+    'disassembleAddressRange',
+    'disassembleAddressRangeByLine',
+    'disassembleFile',
+    'disassembleFileByLine',
+    'getThread',
+    'getThreads',
+    'getProcessSnapshot',
+    'getAllThreadStacks',
+    'loadPythonHelper',
+    'attachToProcess',
+    'detach'
+  ];
+  functionsToLog.forEach((funcName: string) => {
+    let func: Function = (<any> debugSession)[funcName];
+    (<any> debugSession)[funcName] = function () {
+      return func.apply(this, arguments)
+      .then((result: any) => {
+        if (debugSession.logger) {
+          debugSession.logger.debug({ func: funcName, result: result });
+        }
+        return result;
+      });
+    };
+  });
+}
+
 /**
  * This function performs the following tasks asynchronously (but sequentially):
  * 1. Adds a breakpoint on the given function.
@@ -89,4 +89,40 @@ log(describe("Debug Session", () => {
       });
     });
   }); // describe #getThreads()
+
+  describe("#getAllThreadStacks()", () => {
+    it("gets the stacks of all the threads in a multi-threaded inferior @skipOnLLDB", () => {
+      return debugSession.setInferiorArguments('--threads 4')
+      .then(() => {
+        return runToFunc(debugSession, 'funcA', () => {
+          const streamedThreadIds: number[] = [];
+          let threads: dbgmits.IThreadInfo[];
+          return debugSession.getThreads()
+          .then((info: dbgmits.IMultiThreadInfo) => {
+            threads = info.all;
+            return debugSession.getAllThreadStacks({
+              maxDepth: 2,
+              includeArgs: true,
+              concurrency: 2,
+              onThreadStack: (stack: dbgmits.IThreadStackInfo) => streamedThreadIds.push(stack.id)
+            });
+          })
+          .then((stacks: dbgmits.IThreadStackInfo[]) => {
+            expect(stacks.map(stack => stack.id)).to.deep.equal(threads.map(thread => thread.id));
+            expect(streamedThreadIds).to.have.members(stacks.map(stack => stack.id));
+            stacks.forEach((stack: dbgmits.IThreadStackInfo) => {
+              expect(stack.error).to.be.undefined;
+              expect(stack.frames.length).to.be.within(1, 2);
+              stack.frames.forEach((frame: dbgmits.IStackFrameDetailedInfo, level: number) => {
+                expect(frame.level).to.equal(level);
+                expect(frame.args).to.be.an('array');
+              });
+            });
+            // the thread that hit the breakpoint should be in funcA()
+            expect(stacks.some(stack => /^funcA/.test(stack.frames[0].func))).to.be.true;
+          });
+        });
+      });
+    });
+  }); // describe #getAllThreadStacks()
 }));
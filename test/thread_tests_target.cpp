@@ -1,13 +1,41 @@
+#include <condition_variable>
 #include <cstdio>
+#include <cstdlib>
+#include <mutex>
 #include <thread>
 #include <vector>
 #include <cstring>
 
+// Worker threads wait here until all of them have been created, so every thread exists by the
+// time the first one calls funcA().
+static std::mutex barrierMutex;
+static std::condition_variable barrierCondition;
+static int numWorkersWaiting = 0;
+
+void waitForAllWorkers(int numWorkers)
+{
+    std::unique_lock<std::mutex> lock(barrierMutex);
+    if (++numWorkersWaiting == numWorkers)
+    {
+        barrierCondition.notify_all();
+    }
+    else
+    {
+        barrierCondition.wait(lock, [numWorkers] { return numWorkersWaiting == numWorkers; });
+    }
+}
+
 void funcA()
 {
     return;
 }
 
+void workerMain(int numWorkers)
+{
+    waitForAllWorkers(numWorkers);
+    funcA();
+}
+
 int main(int argc, const char *argv[])
 {
     int threadCount = 1;
@@ -23,7 +51,7 @@ int main(int argc, const char *argv[])
     std::vector<std::thread> threads;
     for (int i = 1; i < threadCount; ++i)
     {
-        threads.push_back(std::thread(funcA));
+        threads.push_back(std::thread(workerMain, threadCount - 1));
     }
     
     for(auto& thread : threads)
@@ -0,0 +1,56 @@
+﻿// Copyright (c) 2016 Vadim Macagon
+// MIT License, see LICENSE file for full terms.
+
+require('source-map-support').install();
+
+import * as chai from 'chai';
+import { formatIntegerValue } from '../lib/value_formats';
+import { WatchFormatSpec } from '../lib/types';
+
+// aliases
+var expect = chai.expect;
+
+describe("Value Formats", () => {
+  describe("formatIntegerValue()", () => {
+    it("formats a positive int", () => {
+      expect(formatIntegerValue('5', 'int', WatchFormatSpec.Binary)).to.equal('101');
+      expect(formatIntegerValue('5', 'int', WatchFormatSpec.Decimal)).to.equal('5');
+      expect(formatIntegerValue('5', 'int', WatchFormatSpec.Hexadecimal)).to.equal('0x5');
+      expect(formatIntegerValue('5', 'int', WatchFormatSpec.Octal)).to.equal('05');
+      expect(formatIntegerValue('5', 'int', WatchFormatSpec.Default)).to.equal('5');
+    });
+
+    it("formats zero", () => {
+      expect(formatIntegerValue('0', 'int', WatchFormatSpec.Binary)).to.equal('0');
+      expect(formatIntegerValue('0', 'int', WatchFormatSpec.Hexadecimal)).to.equal('0x0');
+      expect(formatIntegerValue('0', 'int', WatchFormatSpec.Octal)).to.equal('0');
+    });
+
+    it("formats negative values as two's complement of the type width", () => {
+      expect(formatIntegerValue('-1', 'int', WatchFormatSpec.Hexadecimal)).to.equal('0xffffffff');
+      expect(formatIntegerValue('-1', 'signed char', WatchFormatSpec.Octal)).to.equal('0377');
+      expect(formatIntegerValue('-2', 'const long long', WatchFormatSpec.Hexadecimal))
+        .to.equal('0xfffffffffffffffe');
+    });
+
+    it("formats 64-bit and 128-bit values without losing precision", () => {
+      expect(formatIntegerValue('18446744073709551615', 'unsigned long long', WatchFormatSpec.Hexadecimal))
+        .to.equal('0xffffffffffffffff');
+      expect(formatIntegerValue('123456789012345678901234567890', 'unsigned __int128', WatchFormatSpec.Hexadecimal))
+        .to.equal('0x18ee90ff6c373e0ee4e3f0ad2');
+      expect(formatIntegerValue('-170141183460469231731687303715884105728', '__int128', WatchFormatSpec.Hexadecimal))
+        .to.equal('0x80000000000000000000000000000000');
+    });
+
+    it("declines to format values it can't format exactly", () => {
+      // the width of long depends on the target platform
+      expect(formatIntegerValue('-5', 'long', WatchFormatSpec.Hexadecimal)).to.be.undefined;
+      expect(formatIntegerValue('5', 'long', WatchFormatSpec.Hexadecimal)).to.equal('0x5');
+      expect(formatIntegerValue('97', 'char', WatchFormatSpec.Default)).to.be.undefined;
+      expect(formatIntegerValue('97', 'uint8_t', WatchFormatSpec.Default)).to.be.undefined;
+      expect(formatIntegerValue('-3', 'const int8_t', WatchFormatSpec.Default)).to.be.undefined;
+      expect(formatIntegerValue('1.5', 'float', WatchFormatSpec.Hexadecimal)).to.be.undefined;
+      expect(formatIntegerValue('0x5', 'int', WatchFormatSpec.Decimal)).to.be.undefined;
+    });
+  });
+});
@@ -95,6 +95,26 @@ log(describe("Debug Session", () => {
       });
     });
 
+    it("#addWatches", () => {
+      return runToFuncAndStepOut(debugSession, 'funcWithMoreVariablesToWatch_Inner', () => {
+        return debugSession.addWatches([
+          { expression: 'e' },
+          { expression: 'noSuchVariable' },
+          { expression: 'f', options: { id: 'watchF' } }
+        ])
+        .then((results: dbgmits.IWatchCreationResult[]) => {
+          expect(results).to.have.length(3);
+          expect(results[0].error).to.be.null;
+          expect(results[0].watch.expressionType).to.equal('Point');
+          expect(results[1].watch).to.be.null;
+          expect(results[1].error).to.be.instanceof(dbgmits.CommandFailedError);
+          expect(results[2].error).to.be.null;
+          expect(results[2].watch).to.have.property('id', 'watchF');
+          expect(results[2].watch).to.have.property('value', '9.5');
+        });
+      });
+    });
+
     describe("#updateWatch", () => {
       it("updates a fixed watch for a local variable after the value changes", () => {
         // check the change in the value of the variable was detected by the watch
@@ -132,6 +152,152 @@ log(describe("Debug Session", () => {
       });
     });
 
+    describe("#setWatchFrozen @skipOnLLDB", () => {
+      it("only updates a frozen watch when it's updated explicitly", () => {
+        return runToFuncAndStepOut(debugSession, 'funcWithMoreVariablesToWatch_Inner', () => {
+          let watch: IWatchInfo;
+          return debugSession.addWatch('f')
+          .then((info: IWatchInfo) => {
+            watch = info;
+            return debugSession.setWatchFrozen(watch.id, true);
+          })
+          .then(() => {
+            expect(debugSession.watchTree.getNode(watch.id).isFrozen).to.be.true;
+            const onStepFinished = new Promise<void>((resolve) => {
+              debugSession.once(dbgmits.EVENT_STEP_FINISHED, () => resolve());
+            });
+            return Promise.all([onStepFinished, debugSession.stepOverLine()]);
+          })
+          .then(() => debugSession.updateWatch('*'))
+          .then((changelist: dbgmits.IWatchUpdateInfo[]) => {
+            expect(changelist).to.be.empty;
+            return debugSession.updateWatch(watch.id, dbgmits.VariableDetailLevel.All);
+          })
+          .then((changelist: dbgmits.IWatchUpdateInfo[]) => {
+            expect(changelist).to.have.length(1);
+            expect(changelist[0].value).to.equal('11');
+          });
+        });
+      });
+    });
+
+    describe("#acquireWatch", () => {
+      it("shares a watch between handles and destroys it once all handles are released", () => {
+        return runToFuncAndStepOut(debugSession, 'funcWithMoreVariablesToWatch_Inner', () => {
+          const scope = debugSession.createWatchScope();
+          let firstHandle: dbgmits.WatchHandle;
+          return scope.acquireWatch('f')
+          .then((handle: dbgmits.WatchHandle) => {
+            firstHandle = handle;
+            return debugSession.acquireWatch('f');
+          })
+          .then((handle: dbgmits.WatchHandle) => {
+            expect(handle.id).to.equal(firstHandle.id);
+            expect(debugSession.liveWatchCount).to.equal(1);
+            const onWatchRemoved = new Promise<void>((resolve) => {
+              debugSession.watchTree.once(dbgmits.EVENT_WATCH_REMOVED, () => resolve());
+            });
+            handle.release();
+            scope.release();
+            expect(firstHandle.isReleased).to.be.true;
+            return onWatchRemoved;
+          })
+          .then(() => {
+            expect(debugSession.liveWatchCount).to.equal(0);
+          });
+        });
+      });
+    });
+
+    describe("#watchTree", () => {
+      it("mirrors watches and their children", () => {
+        return runToFuncAndStepOut(debugSession, 'funcWithMoreVariablesToWatch_Inner', () => {
+          return debugSession.addWatch('f')
+          .then((watch: IWatchInfo) => {
+            expect(debugSession.watchTree.roots).to.have.length(1);
+            const node = debugSession.watchTree.getNode(watch.id);
+            expect(node).to.have.property('expression', 'f');
+            expect(node).to.have.property('value', '9.5');
+            expect(node.parent).to.be.null;
+            return debugSession.addWatch('e');
+          })
+          .then((watch: IWatchInfo) => {
+            return debugSession.getWatchChildren(watch.id)
+            .then((children: dbgmits.IWatchChildInfo[]) => {
+              const node = debugSession.watchTree.getNode(watch.id);
+              expect(node.children).to.have.length(children.length);
+              expect(node.children[0].parent).to.equal(node);
+              return debugSession.removeWatch(watch.id);
+            });
+          })
+          .then(() => {
+            expect(debugSession.watchTree.roots).to.have.length(1);
+            expect(debugSession.watchTree.size).to.equal(1);
+          });
+        });
+      });
+
+      it("emits an event when the value of a watch changes", () => {
+        return runToFuncAndStepOut(debugSession, 'funcWithMoreVariablesToWatch_Inner', () => {
+          let onValueChanged: Promise<dbgmits.IWatchValueChangedEvent>;
+          return debugSession.addWatch('f')
+          .then((watch: IWatchInfo) => {
+            onValueChanged = new Promise<dbgmits.IWatchValueChangedEvent>((resolve) => {
+              debugSession.watchTree.once(dbgmits.EVENT_WATCH_VALUE_CHANGED, resolve);
+            });
+            const onStepFinished = new Promise<void>((resolve) => {
+              debugSession.once(dbgmits.EVENT_STEP_FINISHED, () => resolve());
+            });
+            return Promise.all([onStepFinished, debugSession.stepOverLine()]);
+          })
+          .then(() => debugSession.updateWatch('*', dbgmits.VariableDetailLevel.All))
+          .then(() => onValueChanged)
+          .then((e: dbgmits.IWatchValueChangedEvent) => {
+            expect(e.node).to.have.property('expression', 'f');
+            expect(e.oldValue).to.equal('9.5');
+            expect(e.node.value).to.equal('11');
+          });
+        });
+      });
+    });
+
+    describe("#subscribeWatch", () => {
+      it("notifies subscribers of changes retrieved by the update of a visible watch", () => {
+        return runToFuncAndStepOut(debugSession, 'funcWithMoreVariablesToWatch_Inner', () => {
+          const updates: dbgmits.IWatchUpdateInfo[] = [];
+          let watchId: string;
+          let onUpdated: Promise<void>;
+          return debugSession.addWatch('f')
+          .then((watch: IWatchInfo) => {
+            watchId = watch.id;
+            // the debugger only reports the change to the first update after the stop, which
+            // will be the update of the visible watches
+            debugSession.updateVisibleWatchesOnStop = true;
+            onUpdated = new Promise<void>((resolve) => {
+              debugSession.subscribeWatch(watchId, (update: dbgmits.IWatchUpdateInfo) => {
+                updates.push(update);
+                resolve();
+              });
+            });
+            return debugSession.setWatchVisibility(watchId, true);
+          })
+          .then(() => {
+            const onStepFinished = new Promise<void>((resolve) => {
+              debugSession.once(dbgmits.EVENT_STEP_FINISHED, () => resolve());
+            });
+            return Promise.all([onStepFinished, debugSession.stepOverLine()]);
+          })
+          .then(() => onUpdated)
+          .then(() => {
+            expect(updates).to.have.length(1);
+            expect(updates[0]).to.have.property('id', watchId);
+            expect(updates[0]).to.have.property('value', '11');
+            expect(debugSession.watchTree.getNode(watchId).isStale).to.be.false;
+          });
+        });
+      });
+    });
+
     describe("#getWatchChildren", () => {
       it("gets a list of members of a simple variable under watch", () => {
         return runToFuncAndStepOut(debugSession, 'funcWithMoreVariablesToWatch', () => {
@@ -280,6 +446,28 @@ log(describe("Debug Session", () => {
       });
     });
 
+    it("#getWatchValues", () => {
+      return runToFuncAndStepOut(debugSession, 'funcWithMoreVariablesToWatch', () => {
+        // watch an integer variable and a floating point one
+        return debugSession.addWatches([{ expression: 'e' }, { expression: 'f' }])
+        .then((results: dbgmits.IWatchCreationResult[]) => {
+          const ids = results.map((result: dbgmits.IWatchCreationResult) => result.watch.id);
+          return debugSession.getWatchValues(ids, dbgmits.WatchFormatSpec.Default)
+          .then((values: string[]) => {
+            expect(values).to.deep.equal(['5', '5']);
+            return debugSession.getWatchValues([ids[0]], dbgmits.WatchFormatSpec.Hexadecimal);
+          })
+          .then((values: string[]) => {
+            expect(values).to.deep.equal(['0x5']);
+            return debugSession.getWatchValues([ids[0]], dbgmits.WatchFormatSpec.Octal);
+          })
+          .then((values: string[]) => {
+            expect(values).to.deep.equal(['05']);
+          });
+        });
+      });
+    });
+
     it("#setWatchValue", () => {
       return runToFuncAndStepOut(debugSession, 'funcWithMoreVariablesToWatch', () => {
         var newValue = '999';
@@ -334,5 +522,35 @@ log(describe("Debug Session", () => {
         });
       });
     });
+
+    it("#exportState / #importState", () => {
+      return runToFuncAndStepOut(debugSession, 'funcWithMoreVariablesToWatch_Inner', () => {
+        return debugSession.addWatch('e')
+        .then(() => debugSession.addWatch('f', { id: 'watchF' }))
+        .then(() => debugSession.addWatch('e.x'))
+        .then((watch: IWatchInfo) => debugSession.removeWatch(watch.id))
+        .then(() => {
+          const state = debugSession.exportState();
+          expect(state.watches).to.have.length(2);
+          expect(state.watches[0]).to.have.property('expression', 'e');
+          expect(state.watches[0].options.id).to.be.undefined;
+          expect(state.watches[1]).to.have.property('expression', 'f');
+          expect(state.watches[1].options).to.have.property('id', 'watchF');
+          // remove the original watches so they can be recreated in the same session
+          return debugSession.pipelineCommands(() => Promise.all([
+            debugSession.removeWatch('watchF'),
+            debugSession.importState(state)
+          ]));
+        })
+        .then((results: any[]) => {
+          const result: dbgmits.ISessionStateImportResult = results[1];
+          expect(result.failedWatches).to.be.empty;
+          expect(result.watches).to.have.length(2);
+          expect(result.watches[0].expressionType).to.equal('Point');
+          expect(result.watches[1]).to.have.property('id', 'watchF');
+          expect(result.watches[1]).to.have.property('value', '9.5');
+        });
+      });
+    });
   });
 }));